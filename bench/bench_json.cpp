@@ -0,0 +1,1452 @@
+
+
+// NOTE: micro benchmarks for uzleo::json. Configure with
+// -DCMAKE_BUILD_TYPE=Release -DBUILD_BENCH=ON for meaningful numbers.
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <malloc.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+import uzleo.json;
+import fmt;
+import std;
+
+namespace {
+
+namespace chr = std::chrono;
+namespace rng = std::ranges;
+
+using json_object_t = uzleo::json::Json::json_object_t;
+using std_object_t = std::unordered_map<std::string, uzleo::json::Json>;
+
+static constexpr std::array kObjectSizes{1'000uz, 10'000uz, 100'000uz,
+                                         1'000'000uz};
+
+/// results are accumulated here so that the measured work is not optimized
+/// away
+double g_sink{0.0};
+
+/// while set, the global operator new/delete, which are replaced below (on
+/// Linux), add/subtract the usable size of each block to g_heap_bytes.
+/// Otherwise they only check this flag, so benchmarks that do not measure
+/// heap bytes run at the speed of plain malloc/free.
+std::atomic<bool> g_count_heap{false};
+std::atomic<std::ptrdiff_t> g_heap_bytes{0};
+
+/// @return heap bytes that fn allocates and does not free again, 0 where
+/// heap bytes are not counted
+template <class Fn>
+auto MeasureRetainedHeap(Fn&& fn) -> std::ptrdiff_t {
+  auto const before{g_heap_bytes.load(std::memory_order_relaxed)};
+  g_count_heap.store(true, std::memory_order_relaxed);
+  std::forward<Fn>(fn)();
+  g_count_heap.store(false, std::memory_order_relaxed);
+  return g_heap_bytes.load(std::memory_order_relaxed) - before;
+}
+
+template <class Fn>
+auto Measure(Fn&& fn) -> chr::nanoseconds {
+  auto const start_time_point{chr::steady_clock::now()};
+  std::forward<Fn>(fn)();
+  return chr::duration_cast<chr::nanoseconds>(chr::steady_clock::now() -
+                                              start_time_point);
+}
+
+auto Report(std::string_view name, std::size_t op_count,
+            chr::nanoseconds duration) {
+  fmt::println("  {:<48} {:>10.2f} ns/op", name,
+               static_cast<double>(duration.count()) /
+                   static_cast<double>(op_count));
+}
+
+auto ReportThroughput(std::string_view name, std::size_t byte_count,
+                      chr::nanoseconds duration) {
+  fmt::println("  {:<48} {:>10.2f} MB/s", name,
+               static_cast<double>(byte_count) * 1e3 /
+                   static_cast<double>(duration.count()));
+}
+
+auto MakeKeys(std::size_t count) -> std::vector<std::string> {
+  return rng::views::iota(0uz, count) |
+         rng::views::transform([](std::size_t index) {
+           return fmt::format("device-{:08}", index);
+         }) |
+         rng::to<std::vector>();
+}
+
+template <class Map>
+auto BenchObjectMap(std::string_view map_name, std::size_t count) {
+  auto const keys{MakeKeys(count)};
+  auto lookup_keys{keys};
+  rng::shuffle(lookup_keys, std::mt19937{42});
+
+  Map map{};
+  Report(fmt::format("{} insert ({} members)", map_name, count), count,
+         Measure([&] {
+           for (auto const& [index, key] : rng::views::enumerate(keys)) {
+             map.try_emplace(key, static_cast<double>(index));
+           }
+         }));
+
+  Report(fmt::format("{} lookup ({} members)", map_name, count), count,
+         Measure([&] {
+           for (auto const& key : lookup_keys) {
+             g_sink += map.find(key)->second.GetDouble();
+           }
+         }));
+
+  Report(fmt::format("{} iterate ({} members)", map_name, count), count,
+         Measure([&] {
+           for (auto const& [key, value] : map) {
+             g_sink += value.GetDouble();
+           }
+         }));
+}
+
+auto BenchParseLargeObject(std::size_t count) {
+  std::string content{"{"};
+  for (auto const& [index, key] : rng::views::enumerate(MakeKeys(count))) {
+    content += fmt::format("{}\"{}\": {}", index == 0 ? "" : ", ", key, index);
+  }
+  content += "}";
+
+  Report(fmt::format("Parse object ({} members)", count), count, Measure([&] {
+           auto const json{uzleo::json::Parse(std::string_view{content})};
+           g_sink += static_cast<double>(rng::size(json.GetMap()));
+         }));
+}
+
+auto ObjectMapBenchmarks() {
+  for (auto const count : kObjectSizes) {
+    BenchObjectMap<json_object_t>("ObjectMap", count);
+    BenchObjectMap<std_object_t>("std::unordered_map", count);
+    BenchParseLargeObject(count);
+    fmt::println("");
+  }
+}
+
+static constexpr std::size_t kRecordCount{10'000};
+
+/// array of kRecordCount same-shaped records with "timestamp" and "value"
+/// members followed by filler members
+auto MakeRecords(std::size_t member_count) -> std::string {
+  std::string content{"["};
+  for (std::size_t record{0}; record < kRecordCount; ++record) {
+    content += record == 0 ? "{" : ", {";
+    content += fmt::format(R"("timestamp": {}, "value": {})", record, record);
+    for (std::size_t member{2}; member < member_count; ++member) {
+      content += fmt::format(R"(, "field{}": {})", member, member);
+    }
+    content += "}";
+  }
+  content += "]";
+  return content;
+}
+
+/// looks up the same few keys in many same-shaped records, with and without
+/// precomputed key hashes
+auto BenchKeyLookup(std::size_t member_count) {
+  static constexpr std::size_t kRepetitions{100};
+
+  auto const json{
+      uzleo::json::Parse(std::string_view{MakeRecords(member_count)})};
+  auto const records{json.GetArray()};
+  auto const op_count{kRecordCount * kRepetitions * 2};
+
+  Report(fmt::format("GetJson(std::string_view) ({} members)", member_count),
+         op_count, Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             for (auto const& record : records) {
+               g_sink += record.GetJson("timestamp").GetDouble() +
+                         record.GetJson("value").GetDouble();
+             }
+           }
+         }));
+
+  static constexpr uzleo::json::Key kTimestamp{"timestamp"};
+  static constexpr uzleo::json::Key kValue{"value"};
+  Report(fmt::format("GetJson(Key) ({} members)", member_count), op_count,
+         Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             for (auto const& record : records) {
+               g_sink += record.GetJson(kTimestamp).GetDouble() +
+                         record.GetJson(kValue).GetDouble();
+             }
+           }
+         }));
+}
+
+auto KeyBenchmarks() {
+  for (auto const member_count : {4uz, 16uz, 64uz}) {
+    BenchKeyLookup(member_count);
+  }
+  fmt::println("");
+}
+
+auto BenchCachedLookup(std::size_t member_count) {
+  static constexpr std::size_t kRepetitions{100};
+
+  auto const json{
+      uzleo::json::Parse(std::string_view{MakeRecords(member_count)})};
+  auto const records{json.GetArray()};
+  auto const op_count{kRecordCount * kRepetitions};
+
+  Report(fmt::format("GetJson(\"value\") ({} members)", member_count),
+         op_count, Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             for (auto const& record : records) {
+               g_sink += record.GetJson("value").GetDouble();
+             }
+           }
+         }));
+
+  uzleo::json::CachedLookup value{"value"};
+  Report(fmt::format("CachedLookup{{\"value\"}} ({} members)", member_count),
+         op_count, Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             for (auto const& record : records) {
+               g_sink += value.Get(record).GetDouble();
+             }
+           }
+         }));
+}
+
+auto CachedLookupBenchmarks() {
+  for (auto const member_count : {4uz, 16uz, 64uz}) {
+    BenchCachedLookup(member_count);
+  }
+  fmt::println("");
+}
+
+auto BenchGetMany(std::size_t member_count) {
+  static constexpr std::size_t kRepetitions{100};
+
+  auto const json{
+      uzleo::json::Parse(std::string_view{MakeRecords(member_count)})};
+  auto const records{json.GetArray()};
+  auto const op_count{kRecordCount * kRepetitions};
+
+  Report(fmt::format("6x GetJson() ({} members)", member_count), op_count,
+         Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             for (auto const& record : records) {
+               g_sink += record.GetJson("timestamp").GetDouble() +
+                         record.GetJson("value").GetDouble() +
+                         record.GetJson("field2").GetDouble() +
+                         record.GetJson("field3").GetDouble() +
+                         record.GetJson("field4").GetDouble() +
+                         record.GetJson("field5").GetDouble();
+             }
+           }
+         }));
+
+  Report(fmt::format("GetMany() of 6 keys ({} members)", member_count),
+         op_count, Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             for (auto const& record : records) {
+               auto const [timestamp, value, field2, field3, field4, field5]{
+                   uzleo::json::GetMany(record, "timestamp", "value",
+                                        "field2", "field3", "field4",
+                                        "field5")};
+               g_sink += timestamp->get().GetDouble() +
+                         value->get().GetDouble() + field2->get().GetDouble() +
+                         field3->get().GetDouble() +
+                         field4->get().GetDouble() + field5->get().GetDouble();
+             }
+           }
+         }));
+}
+
+auto GetManyBenchmarks() {
+  for (auto const member_count : {6uz, 8uz, 64uz}) {
+    BenchGetMany(member_count);
+  }
+  fmt::println("");
+}
+
+/// same records either minified or pretty-printed with 4 space indentation
+auto MakeSensorDocument(std::size_t record_count, bool pretty)
+    -> std::string {
+  auto const newline{[pretty](std::size_t depth) {
+    return pretty ? fmt::format("\n{:{}}", "", depth * 4) : std::string{};
+  }};
+  auto const separator{pretty ? ": " : ":"};
+
+  std::string content{"["};
+  for (std::size_t record{0}; record < record_count; ++record) {
+    content += record == 0 ? "" : ",";
+    content += newline(1) + "{";
+    content += fmt::format(R"({}"id"{}{},)", newline(2), separator, record);
+    content += fmt::format(R"({}"name"{}"sensor-{}",)", newline(2), separator,
+                           record);
+    content += fmt::format(R"({}"location"{}{{)", newline(2), separator);
+    content += fmt::format(R"({}"lat"{}{},)", newline(3), separator,
+                           48.1 + static_cast<double>(record % 100) / 1000);
+    content += fmt::format(R"({}"lon"{}{})", newline(3), separator,
+                           11.5 + static_cast<double>(record % 10) / 100);
+    content += newline(2) + "},";
+    content += fmt::format(R"({}"tags"{}[{}"outdoor",{}"humidity"{}],)",
+                           newline(2), separator, newline(3), newline(3),
+                           newline(2));
+    content += fmt::format(R"({}"active"{}true)", newline(2), separator);
+    content += newline(1) + "}";
+  }
+  content += newline(0) + "]";
+  return content;
+}
+
+auto WhitespaceBenchmarks() {
+  static constexpr std::size_t kRepetitions{10};
+
+  for (auto const pretty : {false, true}) {
+    auto const content{MakeSensorDocument(100'000, pretty)};
+    auto const whitespace_count{rng::count_if(content, [](char c) {
+      return c == ' ' or c == '\n';
+    })};
+
+    ReportThroughput(
+        fmt::format("Parse {} input ({:.0f}% whitespace)",
+                    pretty ? "pretty" : "minified",
+                    100.0 * static_cast<double>(whitespace_count) /
+                        static_cast<double>(rng::size(content))),
+        rng::size(content) * kRepetitions, Measure([&] {
+          for (std::size_t repetition{0}; repetition < kRepetitions;
+               ++repetition) {
+            auto const json{uzleo::json::Parse(std::string_view{content})};
+            g_sink += static_cast<double>(rng::size(json.GetArray()));
+          }
+        }));
+  }
+  fmt::println("");
+}
+
+auto StreamArrayBenchmarks() {
+  static constexpr std::size_t kStreamRecordCount{1'000'000};
+
+  auto const file_path{std::filesystem::temp_directory_path() /
+                       "uzleo_json_bench_stream.json"};
+  auto const content{MakeSensorDocument(kStreamRecordCount, false)};
+  {
+    std::ofstream file_stream{file_path, std::ios::binary};
+    file_stream << content;
+  }
+
+  ReportThroughput(
+      fmt::format("StreamArray over {} records", kStreamRecordCount),
+      rng::size(content), Measure([&] {
+        for (auto& record :
+             uzleo::json::StreamArray(std::filesystem::path{file_path})) {
+          g_sink += record.GetJson("id").GetDouble();
+        }
+      }));
+  ReportThroughput(
+      fmt::format("Parse file of {} records", kStreamRecordCount),
+      rng::size(content), Measure([&] {
+        auto const json{uzleo::json::Parse(std::filesystem::path{file_path})};
+        g_sink += static_cast<double>(rng::size(json.GetArray()));
+      }));
+
+  std::filesystem::remove(file_path);
+  fmt::println("");
+}
+
+static constexpr std::array kTiers{
+    uzleo::json::KernelTier::kScalar, uzleo::json::KernelTier::kSwar,
+    uzleo::json::KernelTier::kSse42, uzleo::json::KernelTier::kAvx2,
+    uzleo::json::KernelTier::kAvx512};
+static constexpr std::array kTierNames{"scalar", "swar", "sse4.2", "avx2",
+                                       "avx512"};
+
+auto KernelTierBenchmarks() {
+  static constexpr std::size_t kRepetitions{10};
+
+  auto const default_tier{uzleo::json::GetKernelTier()};
+  auto const content{MakeSensorDocument(100'000, true)};
+  for (auto const& [tier, tier_name] : rng::views::zip(kTiers, kTierNames)) {
+    if (not uzleo::json::IsKernelTierSupported(tier)) {
+      continue;
+    }
+
+    uzleo::json::SetKernelTier(tier);
+    ReportThroughput(fmt::format("Parse pretty input ({} tier)", tier_name),
+                     rng::size(content) * kRepetitions, Measure([&] {
+                       for (std::size_t repetition{0};
+                            repetition < kRepetitions; ++repetition) {
+                         auto const json{
+                             uzleo::json::Parse(std::string_view{content})};
+                         g_sink += static_cast<double>(
+                             rng::size(json.GetArray()));
+                       }
+                     }));
+  }
+  uzleo::json::SetKernelTier(default_tier);
+  fmt::println("");
+}
+
+auto DumpToFileBenchmarks() {
+  auto const file_path{std::filesystem::temp_directory_path() /
+                       "uzleo_json_bench_dump.json"};
+  auto const json{
+      uzleo::json::Parse(std::string_view{MakeSensorDocument(500'000, false)})};
+  auto const dump_size{rng::size(json.Dump())};
+
+  ReportThroughput("Dump() then write", dump_size, Measure([&] {
+                     std::ofstream file_stream{file_path, std::ios::binary};
+                     file_stream << json.Dump();
+                   }));
+  for (auto const sync : {false, true}) {
+    ReportThroughput(fmt::format("DumpToFile (sync: {})", sync), dump_size,
+                     Measure([&] {
+                       uzleo::json::DumpToFile(
+                           std::filesystem::path{file_path}, json,
+                           {.sync = sync});
+                     }));
+  }
+
+  std::filesystem::remove(file_path);
+  fmt::println("");
+}
+
+auto FormatterBenchmarks() {
+  static constexpr std::size_t kRepetitions{10'000};
+
+  auto const json{
+      uzleo::json::Parse(std::string_view{MakeSensorDocument(1, false)})};
+  auto const& record{json.GetArray()[0]};
+
+  Report("Dump() into a new string", kRepetitions, Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             g_sink += static_cast<double>(rng::size(record.Dump()));
+           }
+         }));
+  std::string buffer{};
+  Report("fmt::format_to() into a reused buffer", kRepetitions, Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             buffer.clear();
+             fmt::format_to(std::back_inserter(buffer), "{:c}", record);
+             g_sink += static_cast<double>(rng::size(buffer));
+           }
+         }));
+  fmt::println("");
+}
+
+auto DumpTruncatedBenchmarks() {
+  static constexpr std::size_t kMaxBytes{4096};
+  static constexpr std::size_t kRepetitions{10};
+
+  auto const json{
+      uzleo::json::Parse(std::string_view{MakeSensorDocument(100'000, false)})};
+  Report("Dump() then truncate to 4 KiB", kRepetitions, Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             auto dumped{json.Dump()};
+             dumped.resize(std::min(rng::size(dumped), kMaxBytes));
+             g_sink += static_cast<double>(rng::size(dumped));
+           }
+         }));
+  Report("DumpTruncated() to 4 KiB", kRepetitions, Measure([&] {
+           for (std::size_t repetition{0}; repetition < kRepetitions;
+                ++repetition) {
+             g_sink += static_cast<double>(
+                 rng::size(uzleo::json::DumpTruncated(json, kMaxBytes)));
+           }
+         }));
+  fmt::println("");
+}
+
+auto Base64Benchmarks() {
+  static constexpr std::size_t kPayloadSize{4 << 20};
+  static constexpr std::size_t kRepetitions{10};
+
+  std::mt19937 generator{42};
+  std::vector<std::byte> payload(kPayloadSize);
+  rng::generate(payload, [&generator] { return std::byte(generator()); });
+  auto const blob{uzleo::json::Json{std::vector<std::byte>{payload}}};
+
+  auto const default_tier{uzleo::json::GetKernelTier()};
+  auto const encoded{uzleo::json::Parse(std::string_view{blob.Dump()})};
+  std::vector<std::byte> buffer{};
+  for (auto const& [tier, tier_name] : rng::views::zip(kTiers, kTierNames)) {
+    if (not uzleo::json::IsKernelTierSupported(tier)) {
+      continue;
+    }
+
+    uzleo::json::SetKernelTier(tier);
+    ReportThroughput(fmt::format("Dump 4 MiB blob ({} tier)", tier_name),
+                     kPayloadSize * kRepetitions, Measure([&] {
+                       for (std::size_t repetition{0};
+                            repetition < kRepetitions; ++repetition) {
+                         g_sink += static_cast<double>(
+                             rng::size(blob.Dump()));
+                       }
+                     }));
+    ReportThroughput(
+        fmt::format("GetBytes of 4 MiB base64 ({} tier)", tier_name),
+        kPayloadSize * kRepetitions, Measure([&] {
+          for (std::size_t repetition{0}; repetition < kRepetitions;
+               ++repetition) {
+            g_sink += static_cast<double>(rng::size(encoded.GetBytes(buffer)));
+          }
+        }));
+  }
+  uzleo::json::SetKernelTier(default_tier);
+  fmt::println("");
+}
+
+auto FrozenBenchmarks() {
+  static constexpr std::size_t kDocumentCount{100};
+
+  // the same records recur across documents, like snapshots of a fleet
+  auto const content{MakeSensorDocument(1'000, false)};
+  std::vector<uzleo::json::Json> parsed{};
+  Report("Parse() 100 documents", kDocumentCount, Measure([&] {
+           for (std::size_t document{0}; document < kDocumentCount;
+                ++document) {
+             parsed.push_back(uzleo::json::Parse(std::string_view{content}));
+           }
+         }));
+
+  uzleo::json::FrozenPool pool{};
+  std::vector<uzleo::json::FrozenJson> frozen{};
+  Report("Freeze() 100 documents", kDocumentCount, Measure([&] {
+           for (std::size_t document{0}; document < kDocumentCount;
+                ++document) {
+             frozen.push_back(
+                 uzleo::json::Freeze(std::string_view{content}, pool));
+           }
+         }));
+  // values per document: root, per record 1 object, 5 members, 2 location
+  // members and 2 tags
+  fmt::println("  {:<48} {} values in {} nodes and {} strings",
+               "Frozen pool", kDocumentCount * (1 + 1'000 * 10),
+               pool.NodeCount(), pool.StringCount());
+
+  Report("operator== on frozen documents", kDocumentCount, Measure([&] {
+           for (auto const& document : frozen) {
+             g_sink += document == frozen.front() ? 1.0 : 0.0;
+           }
+         }));
+  Report("operator== on parsed documents", kDocumentCount, Measure([&] {
+           for (auto const& document : parsed) {
+             g_sink += document == parsed.front() ? 1.0 : 0.0;
+           }
+         }));
+  fmt::println("");
+}
+
+auto CompactBenchmarks() {
+  static constexpr std::size_t kDocumentCount{100'000};
+
+  auto const record{[](std::size_t index) {
+    return fmt::format(
+        R"({{"id":{},"name":"sensor-{}","location":{{"lat":{},"lon":{}}},)"
+        R"("tags":["outdoor","humidity"],"active":true}})",
+        index, index, 48.1 + static_cast<double>(index % 100) / 1000,
+        11.5 + static_cast<double>(index % 10) / 100);
+  }};
+
+  std::vector<uzleo::json::Json> documents{};
+  documents.reserve(kDocumentCount);
+  auto const json_bytes{MeasureRetainedHeap([&] {
+    for (std::size_t index{0}; index < kDocumentCount; ++index) {
+      documents.push_back(uzleo::json::Parse(std::string_view{record(index)}));
+    }
+  })};
+
+  std::vector<uzleo::json::CompactJson> compact_documents{};
+  compact_documents.reserve(kDocumentCount);
+  auto const compact_bytes{MeasureRetainedHeap([&] {
+    for (auto const& document : documents) {
+      compact_documents.push_back(
+          uzleo::json::CompactJson::FromJson(document));
+    }
+  })};
+  fmt::println("  {:<48} {:>10.1f} bytes/doc", "Json tree",
+               static_cast<double>(json_bytes) / kDocumentCount);
+  fmt::println("  {:<48} {:>10.1f} bytes/doc", "CompactJson",
+               static_cast<double>(compact_bytes) / kDocumentCount);
+
+  Report("Json GetJson(location).GetJson(lat)", kDocumentCount, Measure([&] {
+           for (auto const& document : documents) {
+             g_sink +=
+                 document.GetJson("location").GetJson("lat").GetDouble();
+           }
+         }));
+  Report("CompactJson GetJson(location).GetJson(lat)", kDocumentCount,
+         Measure([&] {
+           for (auto const& document : compact_documents) {
+             g_sink += document.Root()
+                           .GetJson("location")
+                           .GetJson("lat")
+                           .GetDouble();
+           }
+         }));
+  Report("Json GetJson(tags).GetArray()[1]", kDocumentCount, Measure([&] {
+           for (auto const& document : documents) {
+             g_sink += static_cast<double>(rng::size(
+                 document.GetJson("tags").GetArray()[1].GetStringView()));
+           }
+         }));
+  Report("CompactJson GetJson(tags).At(1)", kDocumentCount, Measure([&] {
+           for (auto const& document : compact_documents) {
+             g_sink += static_cast<double>(rng::size(
+                 document.Root().GetJson("tags").At(1).GetStringView()));
+           }
+         }));
+  Report("CompactJson ToJson()", kDocumentCount, Measure([&] {
+           for (auto const& document : compact_documents) {
+             g_sink += document.Root().ToJson().IsType<
+                           uzleo::json::Json::json_object_t>()
+                           ? 1.0
+                           : 0.0;
+           }
+         }));
+  fmt::println("");
+}
+
+auto DeltaBenchmarks() {
+  static constexpr std::size_t kStepCount{1'000};
+  static constexpr std::size_t kMetricCount{200};
+
+  // every second a few of the metrics of a producer change
+  std::vector<double> metrics(kMetricCount, 0.0);
+  std::vector<std::string> contents{};
+  for (std::size_t step{0}; step < kStepCount; ++step) {
+    for (std::size_t metric{step % 20}; metric < kMetricCount; metric += 20) {
+      metrics[metric] = static_cast<double>(step * kMetricCount + metric) / 8;
+    }
+    std::string content{R"({"producer": "node-17", "metrics": {)"};
+    for (std::size_t metric{0}; metric < kMetricCount; ++metric) {
+      content += fmt::format(R"({}"m{}": {})", metric == 0 ? "" : ", ", metric,
+                             metrics[metric]);
+    }
+    content += "}}";
+    contents.push_back(std::move(content));
+  }
+  std::vector<uzleo::json::Json> documents{};
+  for (auto const& content : contents) {
+    documents.push_back(uzleo::json::Parse(std::string_view{content}));
+  }
+
+  uzleo::json::DeltaEncoder encoder{};
+  std::vector<std::vector<std::byte>> deltas{};
+  Report("DeltaEncoder::Encode()", kStepCount, Measure([&] {
+           for (auto const& document : documents) {
+             deltas.push_back(encoder.Encode(document));
+           }
+         }));
+  uzleo::json::DeltaDecoder decoder{};
+  Report("DeltaDecoder::Apply()", kStepCount, Measure([&] {
+           for (auto const& delta : deltas) {
+             g_sink += static_cast<double>(
+                 rng::size(decoder.Apply(delta).GetJson("metrics").GetMap()));
+           }
+         }));
+  Report("Parse() of full document", kStepCount, Measure([&] {
+           for (auto const& content : contents) {
+             g_sink += static_cast<double>(rng::size(
+                 uzleo::json::Parse(std::string_view{content})
+                     .GetJson("metrics")
+                     .GetMap()));
+           }
+         }));
+
+  // the first delta carries the whole document
+  auto const bytes_per_step{[](auto const& messages) {
+    std::size_t byte_count{0};
+    for (auto const& message : messages | std::views::drop(1)) {
+      byte_count += rng::size(message);
+    }
+    return static_cast<double>(byte_count) / (kStepCount - 1);
+  }};
+  fmt::println("  {:<48} {:>10.1f} bytes/step", "full document",
+               bytes_per_step(contents));
+  fmt::println("  {:<48} {:>10.1f} bytes/step", "delta",
+               bytes_per_step(deltas));
+  fmt::println("");
+}
+
+auto SortNdjsonBenchmarks() {
+  static constexpr std::size_t kRecordCount{500'000};
+
+  auto const input_path{std::filesystem::temp_directory_path() /
+                        "uzleo_json_bench_sort.ndjson"};
+  auto const output_path{std::filesystem::temp_directory_path() /
+                         "uzleo_json_bench_sorted.ndjson"};
+  std::size_t input_size{0};
+  {
+    std::mt19937_64 engine{42};
+    std::ofstream file_stream{input_path, std::ios::binary};
+    for (std::size_t record{0}; record < kRecordCount; ++record) {
+      auto const line{fmt::format(
+          R"({{"id":{},"sensor":{{"name":"sensor-{}","ts":{}}},)"
+          R"("tags":["outdoor","humidity"],"value":{}}})"
+          "\n",
+          record, record % 1000, engine() % 1'000'000'000, record * 0.5)};
+      input_size += rng::size(line);
+      file_stream << line;
+    }
+  }
+
+  // the approach SortNdjson() replaces
+  ReportThroughput(
+      "Parse all, sort, Dump", input_size, Measure([&] {
+        std::ifstream file_stream{input_path, std::ios::binary};
+        std::vector<uzleo::json::Json> records{};
+        for (std::string line{}; std::getline(file_stream, line);) {
+          records.push_back(uzleo::json::Parse(std::string_view{line}));
+        }
+        rng::stable_sort(records, {}, [](auto const& record) {
+          return record.GetJson("sensor").GetJson("ts").GetDouble();
+        });
+        std::ofstream output{output_path, std::ios::binary};
+        for (auto const& record : records) {
+          output << record.Dump() << '\n';
+        }
+      }));
+
+  // memory budget and thread count (0: one per hardware thread)
+  static constexpr std::array kConfigs{std::pair{std::size_t{1} << 30, 1uz},
+                                       std::pair{std::size_t{1} << 30, 0uz},
+                                       std::pair{std::size_t{8} << 20, 0uz}};
+  for (auto const [memory_budget, thread_count] : kConfigs) {
+    ReportThroughput(
+        fmt::format("SortNdjson ({} MiB runs, {} threads)",
+                    memory_budget >> 20,
+                    thread_count == 0 ? std::thread::hardware_concurrency()
+                                      : thread_count),
+        input_size, Measure([&] {
+          g_sink += static_cast<double>(uzleo::json::SortNdjson(
+              std::filesystem::path{input_path},
+              std::filesystem::path{output_path}, "/sensor/ts",
+              {.memory_budget = memory_budget,
+               .thread_count = thread_count,
+               .sync = false}));
+        }));
+  }
+
+  std::filesystem::remove(input_path);
+  std::filesystem::remove(output_path);
+  fmt::println("");
+}
+
+auto EditableBenchmarks() {
+  static constexpr std::size_t kRecordCount{20'000};
+  static constexpr std::size_t kEditCount{1'000};
+  static constexpr std::size_t kParseCount{20};
+
+  auto const content{MakeSensorDocument(kRecordCount, true)};
+  // a keystroke typing over the first digit of the ids of random records
+  std::vector<std::size_t> offsets{};
+  for (auto offset{content.find(R"("id": )")}; offset != std::string::npos;
+       offset = content.find(R"("id": )", offset + 1)) {
+    offsets.push_back(offset + 6);
+  }
+  std::mt19937_64 engine{42};
+  rng::shuffle(offsets, engine);
+  offsets.resize(kEditCount);
+
+  auto document{uzleo::json::EditableJson::FromContent(content)};
+  fmt::println("  document of {} bytes", rng::size(content));
+  Report("EditableJson::Apply() of a keystroke", kEditCount, Measure([&] {
+           for (auto const offset : offsets) {
+             auto const reparsed{document.Apply(
+                 {.offset = offset, .removed = 1, .inserted = "7"})};
+             g_sink += static_cast<double>(reparsed.end - reparsed.begin);
+           }
+         }));
+  Report("Parse() after a keystroke", kParseCount, Measure([&] {
+           for (std::size_t parse{0}; parse < kParseCount; ++parse) {
+             g_sink += static_cast<double>(rng::size(
+                 uzleo::json::Parse(document.Content()).GetArray()));
+           }
+         }));
+  fmt::println("");
+}
+
+/// number statistics of a document, for the Visit() benchmarks
+struct NumberStatisticsVisitor {
+  struct state_type {
+    std::size_t count{0};
+    double sum{0.0};
+    double max{-std::numeric_limits<double>::infinity()};
+  };
+
+  auto Visit(uzleo::json::Json const& json, std::size_t,
+             state_type& state) const -> void {
+    if (json.IsType<double>()) {
+      ++state.count;
+      state.sum += json.GetDouble();
+      state.max = std::max(state.max, json.GetDouble());
+    }
+  }
+
+  auto Merge(state_type& state, state_type&& other) const -> void {
+    state.count += other.count;
+    state.sum += other.sum;
+    state.max = std::max(state.max, other.max);
+  }
+};
+
+auto VisitBenchmarks() {
+  static constexpr std::size_t kRecordCount{500'000};
+
+  auto const json{uzleo::json::Parse(
+      std::string_view{MakeSensorDocument(kRecordCount, false)})};
+  // each record is an object of 5 members, 2 coordinates and 2 tags
+  auto const value_count{kRecordCount * 10 + 1};
+  auto const hardware_threads{std::max(
+      std::size_t{1}, std::size_t{std::thread::hardware_concurrency()})};
+
+  Report("Visit() pre-order", value_count, Measure([&] {
+           g_sink += uzleo::json::Visit(
+                         json, NumberStatisticsVisitor{},
+                         {.mode = uzleo::json::VisitMode::kPreOrder})
+                         .sum;
+         }));
+  // with one thread Visit() falls back to the pre-order walk measured above
+  for (auto const thread_count :
+       {std::size_t{2}, std::size_t{4},
+        std::max(hardware_threads, std::size_t{2})}) {
+    Report(fmt::format("Visit() parallel ({} threads)", thread_count),
+           value_count, Measure([&] {
+             g_sink += uzleo::json::Visit(json, NumberStatisticsVisitor{},
+                                          {.thread_count = thread_count})
+                           .sum;
+           }));
+  }
+  fmt::println("");
+}
+
+/// api-like bodies of roughly 200 B - 4 KB: users, orders with a varying
+/// number of items and events with nested metadata. Every document has an
+/// "id" and a "type" member.
+auto MakeSmallDocuments(std::size_t count) -> std::vector<std::string> {
+  std::mt19937_64 engine{42};
+  std::vector<std::string> documents{};
+  for (std::size_t document{0}; document < count; ++document) {
+    switch (engine() % 3) {
+      case 0: {
+        documents.push_back(fmt::format(
+            R"({{"id": {}, "type": "user", "name": "user-{}", )"
+            R"("email": "user-{}@example.com", "active": {}, )"
+            R"("roles": ["reader", "writer"], "score": {}}})",
+            document, engine() % 100'000, document,
+            engine() % 2 == 0 ? "true" : "false",
+            static_cast<double>(engine() % 10'000) / 100));
+        break;
+      }
+      case 1: {
+        std::string items{};
+        for (std::size_t item{0}, item_count{1 + engine() % 70};
+             item < item_count; ++item) {
+          items += fmt::format(
+              R"({}{{"sku": "sku-{:06}", "quantity": {}, "price": {}}})",
+              item == 0 ? "" : ", ", engine() % 1'000'000, 1 + engine() % 5,
+              static_cast<double>(engine() % 100'000) / 100);
+        }
+        documents.push_back(fmt::format(
+            R"({{"id": {}, "type": "order", "customer": {}, )"
+            R"("currency": "EUR", "items": [{}], "paid": true}})",
+            document, engine() % 100'000, items));
+        break;
+      }
+      default: {
+        std::string tags{};
+        for (std::size_t tag{0}, tag_count{engine() % 40}; tag < tag_count;
+             ++tag) {
+          tags += fmt::format(R"({}"tag-{}")", tag == 0 ? "" : ", ",
+                              engine() % 1'000);
+        }
+        documents.push_back(fmt::format(
+            R"({{"id": {}, "type": "event", "ts": {}, )"
+            R"("meta": {{"source": "sensor-{}", "region": "eu-west", )"
+            R"("trace": {{"span": "{:016x}", "sampled": false}}}}, )"
+            R"("tags": [{}], "payload": null}})",
+            document, 1'700'000'000 + engine() % 1'000'000, engine() % 100,
+            engine(), tags));
+        break;
+      }
+    }
+  }
+  return documents;
+}
+
+/// @return latency of each of sample_count calls of fn(sample), flushing the
+/// caches before each call if cold. untimed(sample) runs before each call,
+/// outside the measurement.
+template <class Fn, class Untimed = decltype([](std::size_t) {})>
+auto SampleLatencies(std::size_t sample_count, bool cold, Fn&& fn,
+                     Untimed&& untimed = {}) -> std::vector<chr::nanoseconds> {
+  // larger than the last level cache of common server cpus
+  static constexpr std::size_t kEvictionSize{64 << 20};
+  static constexpr std::size_t kCacheLineSize{64};
+  static std::vector<std::uint8_t> eviction_buffer(kEvictionSize);
+
+  std::vector<chr::nanoseconds> latencies{};
+  latencies.reserve(sample_count);
+  for (std::size_t sample{0}; sample < sample_count; ++sample) {
+    untimed(sample);
+    if (cold) {
+      for (std::size_t offset{0}; offset < kEvictionSize;
+           offset += kCacheLineSize) {
+        ++eviction_buffer[offset];
+      }
+    }
+    latencies.push_back(Measure([&] { fn(sample); }));
+  }
+  return latencies;
+}
+
+auto ReportPercentiles(std::string_view name,
+                       std::vector<chr::nanoseconds> latencies) {
+  rng::sort(latencies);
+  auto const percentile{[&latencies](double fraction) {
+    auto const index{static_cast<std::size_t>(
+        fraction * static_cast<double>(rng::size(latencies) - 1))};
+    return latencies[index].count();
+  }};
+  fmt::println("  {:<32} p50 {:>7} p90 {:>7} p99 {:>7} p999 {:>7} ns", name,
+               percentile(0.5), percentile(0.9), percentile(0.99),
+               percentile(0.999));
+}
+
+/// per-call latency percentiles of Parse(), lookups and Dump() over a mix of
+/// small documents, where fixed per-call costs dominate. Warm calls cycle
+/// through documents that stay in cache; cold calls flush the caches first.
+auto LatencyBenchmarks() {
+  static constexpr std::size_t kDocumentCount{1'000};
+  static constexpr std::size_t kWarmSampleCount{200'000};
+  static constexpr std::size_t kColdSampleCount{2'000};
+
+  auto const contents{MakeSmallDocuments(kDocumentCount)};
+  auto const sizes{contents | rng::views::transform(rng::size)};
+  fmt::println("  {} documents of {} - {} bytes", kDocumentCount,
+               rng::min(sizes), rng::max(sizes));
+  std::vector<uzleo::json::Json> documents{};
+  for (auto const& content : contents) {
+    documents.push_back(uzleo::json::Parse(std::string_view{content}));
+  }
+  ReportPercentiles(
+      "steady_clock::now() overhead",
+      SampleLatencies(kWarmSampleCount, false, [](std::size_t) {}));
+
+  for (auto const cold : {false, true}) {
+    auto const sample_count{cold ? kColdSampleCount : kWarmSampleCount};
+    auto const variant{cold ? "cold" : "warm"};
+
+    // the previous document is destroyed outside the measurement
+    std::optional<uzleo::json::Json> parsed{};
+    ReportPercentiles(
+        fmt::format("Parse() {}", variant),
+        SampleLatencies(
+            sample_count, cold,
+            [&](std::size_t sample) {
+              parsed.emplace(uzleo::json::Parse(
+                  std::string_view{contents[sample % kDocumentCount]}));
+            },
+            [&](std::size_t) { parsed.reset(); }));
+    ReportPercentiles(
+        fmt::format("GetJson() of 2 members {}", variant),
+        SampleLatencies(sample_count, cold, [&](std::size_t sample) {
+          auto const& document{documents[sample % kDocumentCount]};
+          g_sink += document.GetJson("id").GetDouble() +
+                    static_cast<double>(rng::size(
+                        document.GetJson("type").GetStringView()));
+        }));
+    ReportPercentiles(
+        fmt::format("Dump() {}", variant),
+        SampleLatencies(sample_count, cold, [&](std::size_t sample) {
+          g_sink += static_cast<double>(
+              rng::size(documents[sample % kDocumentCount].Dump()));
+        }));
+  }
+  fmt::println("");
+}
+
+/// @return resident set size in bytes, 0 where /proc is not available
+auto ResidentSetSize() -> std::size_t {
+  std::ifstream status{"/proc/self/status"};
+  for (std::string line{}; std::getline(status, line);) {
+    if (line.starts_with("VmRSS:")) {
+      std::size_t kilobytes{0};
+      auto const digits{line.find_first_of("0123456789")};
+      if (digits != std::string::npos) {
+        std::from_chars(rng::data(line) + digits,
+                        rng::data(line) + rng::size(line), kilobytes);
+      }
+      return kilobytes << 10;
+    }
+  }
+  return 0;
+}
+
+/// bytes glibc malloc obtained from the system and bytes free within them
+struct AllocatorStats {
+  std::size_t heap_bytes{0};
+  std::size_t free_bytes{0};
+};
+
+/// @return std::nullopt where malloc does not report them (before glibc
+/// 2.33 and on other C libraries)
+auto GetAllocatorStats() -> std::optional<AllocatorStats> {
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  auto const info{mallinfo2()};
+  return AllocatorStats{.heap_bytes = info.arena + info.hblkhd,
+                        .free_bytes = info.fordblks};
+#else
+  return std::nullopt;
+#endif
+}
+
+/// runs randomized parse/mutate/dump/destroy cycles over documents of 200 B
+/// to ~2 MB for duration and samples throughput, RSS and the heap bytes
+/// allocated through operator new since the start and still live. An RSS
+/// that keeps growing while live heap stays flat is fragmentation (or memory
+/// the allocator holds on to). On glibc the heap and free columns tell the
+/// two apart: free bytes growing with the heap are fragmentation. Uses the
+/// global operator new, so preloading another allocator (e.g.
+/// LD_PRELOAD=libjemalloc.so) compares allocator strategies; its heap is not
+/// reported by glibc.
+auto SoakBenchmark(chr::seconds duration) {
+  static constexpr std::size_t kSlotCount{64};
+  static constexpr int kSampleCount{30};
+
+  std::mt19937_64 engine{42};
+  auto corpus{MakeSmallDocuments(200)};
+  for (std::size_t document{0}; document < 40; ++document) {
+    // record counts spread over 1 - 8192 on a log scale
+    corpus.push_back(MakeSensorDocument(
+        std::size_t{1} << (engine() % 14), engine() % 2 == 0));
+  }
+  rng::shuffle(corpus, engine);
+
+  // documents stay alive for a random number of cycles
+  std::vector<std::optional<uzleo::json::Json>> slots(kSlotCount);
+  auto const mutate{[&engine](uzleo::json::Json&& json) {
+    json_object_t json_object{};
+    if (json.IsType<json_object_t>()) {
+      json_object = std::move(json).GetMap();
+    } else {
+      json_object.emplace("records", std::move(json));
+    }
+    if (not rng::empty(json_object) and engine() % 2 == 0) {
+      std::string const key{rng::begin(json_object)->first};
+      json_object.erase(key);
+    }
+    for (std::size_t member{0}, member_count{engine() % 8};
+         member < member_count; ++member) {
+      json_object.try_emplace(
+          fmt::format("extra-{}", engine() % 16),
+          uzleo::json::Json{std::string_view{
+              std::string(engine() % 2048, 'x')}});
+    }
+    return uzleo::json::Json{std::move(json_object)};
+  }};
+
+  auto const sample_interval{std::max<chr::nanoseconds>(
+      chr::seconds{1}, duration / kSampleCount)};
+  fmt::println("  {} documents of 200 B - ~2 MB, {} live, {} s",
+               rng::size(corpus), kSlotCount, duration.count());
+  fmt::println("  {:>8} {:>12} {:>10} {:>12} {:>10} {:>10} {:>10}", "time s",
+               "cycles/s", "RSS MiB", "live MiB", "RSS/live", "heap MiB",
+               "free MiB");
+
+  auto const start_heap_bytes{g_heap_bytes.load(std::memory_order_relaxed)};
+  g_count_heap.store(true, std::memory_order_relaxed);
+  auto const start_time_point{chr::steady_clock::now()};
+  auto sample_time_point{start_time_point};
+  std::size_t cycle_count{0};
+  while (true) {
+    auto& slot{slots[engine() % kSlotCount]};
+    slot.reset();
+    slot.emplace(mutate(uzleo::json::Parse(
+        std::string_view{corpus[engine() % rng::size(corpus)]})));
+    g_sink += static_cast<double>(rng::size(slot->Dump()));
+    ++cycle_count;
+
+    if (cycle_count % 16 != 0) {
+      continue;
+    }
+    auto const now{chr::steady_clock::now()};
+    if (now - sample_time_point < sample_interval) {
+      continue;
+    }
+    auto const live_bytes{static_cast<std::size_t>(std::max(
+        g_heap_bytes.load(std::memory_order_relaxed) - start_heap_bytes,
+        std::ptrdiff_t{1}))};
+    auto const resident_bytes{ResidentSetSize()};
+    std::string heap_mebibytes{"n/a"};
+    std::string free_mebibytes{"n/a"};
+    if (auto const allocator_stats{GetAllocatorStats()}) {
+      heap_mebibytes = fmt::format(
+          "{:.1f}",
+          static_cast<double>(allocator_stats->heap_bytes) / (1 << 20));
+      free_mebibytes = fmt::format(
+          "{:.1f}",
+          static_cast<double>(allocator_stats->free_bytes) / (1 << 20));
+    }
+    fmt::println("  {:>8} {:>12.0f} {:>10.1f} {:>12.1f} {:>10.2f} {:>10} "
+                 "{:>10}",
+                 chr::duration_cast<chr::seconds>(now - start_time_point)
+                     .count(),
+                 static_cast<double>(cycle_count) /
+                     chr::duration<double>(now - sample_time_point).count(),
+                 static_cast<double>(resident_bytes) / (1 << 20),
+                 static_cast<double>(live_bytes) / (1 << 20),
+                 static_cast<double>(resident_bytes) /
+                     static_cast<double>(live_bytes),
+                 heap_mebibytes, free_mebibytes);
+    cycle_count = 0;
+    sample_time_point = now;
+    if (now - start_time_point >= duration) {
+      break;
+    }
+  }
+  g_count_heap.store(false, std::memory_order_relaxed);
+  fmt::println("");
+}
+
+/// hardware counters of the calling thread, read through perf_event_open().
+/// The counters form one group led by the cycles counter, so the kernel
+/// schedules them together and ratios such as IPC cover the same window.
+/// Counters that are not permitted (perf_event_paranoid, containers) or not
+/// supported (many VMs) read as std::nullopt, all of them if cycles are not;
+/// where the kernel multiplexes the group its values are scaled to the full
+/// measured interval.
+class PerfCounters final {
+ public:
+  enum Counter : std::uint8_t {
+    kCycles,
+    kInstructions,
+    kBranchMisses,
+    kCacheMisses,
+    kCounterCount
+  };
+  using Sample = std::array<std::optional<double>, kCounterCount>;
+
+  PerfCounters() {
+#if defined(__linux__)
+    static constexpr std::array<std::uint64_t, kCounterCount> kConfigs{
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+    for (std::size_t counter{0}; counter < kCounterCount; ++counter) {
+      auto const leader_fd{m_fds[kCycles]};
+      if (counter != kCycles and leader_fd == -1) {
+        break;
+      }
+      perf_event_attr attributes{};
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.size = sizeof(attributes);
+      attributes.config = kConfigs[counter];
+      // members follow the leader, which is enabled in Count()
+      attributes.disabled = counter == kCycles ? 1 : 0;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv = 1;
+      attributes.read_format = PERF_FORMAT_GROUP |
+                               PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+      m_fds[counter] = static_cast<int>(
+          syscall(SYS_perf_event_open, &attributes, 0, -1, leader_fd, 0));
+    }
+#endif
+  }
+
+  ~PerfCounters() {
+#if defined(__linux__)
+    for (auto const fd : m_fds) {
+      if (fd != -1) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  PerfCounters(PerfCounters const&) = delete;
+  auto operator=(PerfCounters const&) -> PerfCounters& = delete;
+
+  [[nodiscard]] auto IsAvailable() const -> bool {
+    return m_fds[kCycles] != -1;
+  }
+
+  /// @return counts of the calling thread while fn runs
+  template <class Fn>
+  auto Count(Fn&& fn) -> Sample {
+#if defined(__linux__)
+    if (not IsAvailable()) {
+      std::forward<Fn>(fn)();
+      return Sample{};
+    }
+    auto const leader_fd{m_fds[kCycles]};
+    ioctl(leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    std::forward<Fn>(fn)();
+    ioctl(leader_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // counter count, time enabled, time running, then the value of each
+    // counter in the group in the order they were opened
+    std::array<std::uint64_t, 3 + kCounterCount> values{};
+    if (::read(leader_fd, rng::data(values), sizeof(values)) <= 0 or
+        values[2] == 0) {
+      // never scheduled, e.g. the group needs more counters than the cpu has
+      return Sample{};
+    }
+
+    Sample sample{};
+    auto value{rng::begin(values) + 3};
+    for (std::size_t counter{0}; counter < kCounterCount; ++counter) {
+      if (m_fds[counter] != -1) {
+        sample[counter] = static_cast<double>(*value++) *
+                          static_cast<double>(values[1]) /
+                          static_cast<double>(values[2]);
+      }
+    }
+    return sample;
+#else
+    std::forward<Fn>(fn)();
+    return Sample{};
+#endif
+  }
+
+ private:
+  std::array<int, kCounterCount> m_fds{-1, -1, -1, -1};
+};
+
+/// counters of a phase per input byte and per token, n/a where a counter is
+/// not available
+auto ReportCounters(std::string_view name, PerfCounters::Sample const& sample,
+                    chr::nanoseconds duration, double byte_count,
+                    double token_count) {
+  auto const ratio{[](std::optional<double> numerator, double denominator) {
+    return numerator.transform([denominator](double value) {
+                      return fmt::format("{:.3f}", value / denominator);
+                    })
+        .value_or("n/a");
+  }};
+  auto const cycles{sample[PerfCounters::kCycles]};
+  auto const instructions{sample[PerfCounters::kInstructions]};
+  fmt::println(
+      "  {:<26} {:>7.3f} {:>7} {:>7} {:>6} {:>8} {:>10} {:>10}", name,
+      static_cast<double>(duration.count()) / byte_count,
+      ratio(cycles, byte_count), ratio(instructions, byte_count),
+      cycles and instructions ? ratio(instructions, *cycles) : "n/a",
+      ratio(cycles, token_count),
+      ratio(sample[PerfCounters::kBranchMisses], token_count),
+      ratio(sample[PerfCounters::kCacheMisses], byte_count / 1024));
+}
+
+/// cycles, instructions, branch and cache misses of the lexing and parsing
+/// phases, to check e.g. that a branchless or SIMD change reduced
+/// mispredictions. Lexing is measured through BuildIndex(), which also
+/// matches brackets, and parsing the tokens through Parse(index).
+auto PerfCounterBenchmarks() {
+  static constexpr std::size_t kRecordCount{100'000};
+  static constexpr std::size_t kRepetitions{5};
+
+  PerfCounters perf_counters{};
+  if (not perf_counters.IsAvailable()) {
+    fmt::println(
+        "  perf_event_open() not permitted or supported, reporting time only "
+        "(see /proc/sys/kernel/perf_event_paranoid)");
+  }
+
+  for (auto const pretty : {false, true}) {
+    auto const content{MakeSensorDocument(kRecordCount, pretty)};
+    auto const byte_count{static_cast<double>(rng::size(content) *
+                                              kRepetitions)};
+    auto const token_count{static_cast<double>(
+        uzleo::json::BuildIndex(std::string_view{content}).TokenCount() *
+        kRepetitions)};
+    fmt::println("  {} document of {} bytes", pretty ? "pretty" : "compact",
+                 rng::size(content));
+    fmt::println("  {:<26} {:>7} {:>7} {:>7} {:>6} {:>8} {:>10} {:>10}",
+                 "phase", "ns/B", "cyc/B", "ins/B", "IPC", "cyc/tok",
+                 "brmiss/tok", "cmiss/KiB");
+
+    auto const report{[&](std::string_view name, auto&& phase) {
+      chr::nanoseconds duration{};
+      auto const sample{perf_counters.Count([&] {
+        duration = Measure([&] {
+          for (std::size_t repetition{0}; repetition < kRepetitions;
+               ++repetition) {
+            phase();
+          }
+        });
+      })};
+      ReportCounters(name, sample, duration, byte_count, token_count);
+    }};
+
+    report("Lex (BuildIndex)", [&] {
+      g_sink += static_cast<double>(
+          uzleo::json::BuildIndex(std::string_view{content}).TokenCount());
+    });
+    auto const index{uzleo::json::BuildIndex(std::string_view{content})};
+    report("ParseTokens (Parse(index))", [&] {
+      g_sink +=
+          static_cast<double>(rng::size(uzleo::json::Parse(index).GetArray()));
+    });
+    report("Parse", [&] {
+      g_sink += static_cast<double>(rng::size(
+          uzleo::json::Parse(std::string_view{content}).GetArray()));
+    });
+    auto const json{uzleo::json::Parse(std::string_view{content})};
+    report("Dump", [&] {
+      g_sink += static_cast<double>(rng::size(json.Dump()));
+    });
+  }
+  fmt::println("");
+}
+
+}  // namespace
+
+#if defined(__linux__)
+// counts heap bytes while g_count_heap is set. The usable size of a block is
+// known to the allocator, so blocks need no size header. The other
+// allocation and deallocation functions forward to these two by default.
+auto operator new(std::size_t size) -> void* {
+  auto* const block{std::malloc(std::max(size, 1uz))};
+  if (block == nullptr) {
+    throw std::bad_alloc{};
+  }
+  if (g_count_heap.load(std::memory_order_relaxed)) {
+    g_heap_bytes.fetch_add(
+        static_cast<std::ptrdiff_t>(malloc_usable_size(block)),
+        std::memory_order_relaxed);
+  }
+  return block;
+}
+
+auto operator delete(void* pointer) noexcept -> void {
+  if (pointer != nullptr and g_count_heap.load(std::memory_order_relaxed)) {
+    g_heap_bytes.fetch_sub(
+        static_cast<std::ptrdiff_t>(malloc_usable_size(pointer)),
+        std::memory_order_relaxed);
+  }
+  std::free(pointer);
+}
+#endif
+
+auto main(int argc, char** argv) -> int {
+  // `bench latency` runs only the latency percentiles, `bench counters` only
+  // the hardware counters, `bench soak [s]` only the soak benchmark (60 s by
+  // default)
+  std::span const args{argv, static_cast<std::size_t>(argc)};
+  auto const mode{rng::size(args) > 1 ? std::string_view{args[1]}
+                                      : std::string_view{}};
+  std::size_t soak_seconds{60};
+  if (mode == "soak" and rng::size(args) > 2) {
+    auto const seconds{std::string_view{args[2]}};
+    if (auto const [ptr, ec]{std::from_chars(
+            rng::data(seconds), rng::data(seconds) + rng::size(seconds),
+            soak_seconds)};
+        ec != std::errc{} or ptr != rng::data(seconds) + rng::size(seconds)) {
+      soak_seconds = 0;
+    }
+  }
+  if ((not mode.empty() and mode != "latency" and mode != "counters" and
+       mode != "soak") or
+      soak_seconds == 0) {
+    fmt::println("usage: {} [latency | counters | soak [seconds]]", args[0]);
+    return 1;
+  }
+
+  try {
+    if (mode == "latency") {
+      fmt::println("*** Benchmarking latency percentiles ***");
+      LatencyBenchmarks();
+      fmt::println("sink: {}", g_sink);
+      return 0;
+    }
+    if (mode == "counters") {
+      fmt::println("*** Benchmarking hardware counters ***");
+      PerfCounterBenchmarks();
+      fmt::println("sink: {}", g_sink);
+      return 0;
+    }
+    if (mode == "soak") {
+      fmt::println("*** Soak benchmark ***");
+      SoakBenchmark(
+          chr::seconds{static_cast<chr::seconds::rep>(soak_seconds)});
+      fmt::println("sink: {}", g_sink);
+      return 0;
+    }
+
+    fmt::println("*** Benchmarking ObjectMap ***");
+    ObjectMapBenchmarks();
+
+    fmt::println("*** Benchmarking Key ***");
+    KeyBenchmarks();
+
+    fmt::println("*** Benchmarking CachedLookup ***");
+    CachedLookupBenchmarks();
+
+    fmt::println("*** Benchmarking GetMany ***");
+    GetManyBenchmarks();
+
+    fmt::println("*** Benchmarking whitespace skipping ***");
+    WhitespaceBenchmarks();
+
+    fmt::println("*** Benchmarking kernel tiers ***");
+    KernelTierBenchmarks();
+
+    fmt::println("*** Benchmarking StreamArray ***");
+    StreamArrayBenchmarks();
+
+    fmt::println("*** Benchmarking base64 ***");
+    Base64Benchmarks();
+
+    fmt::println("*** Benchmarking DumpToFile ***");
+    DumpToFileBenchmarks();
+
+    fmt::println("*** Benchmarking formatter ***");
+    FormatterBenchmarks();
+
+    fmt::println("*** Benchmarking DumpTruncated ***");
+    DumpTruncatedBenchmarks();
+
+    fmt::println("*** Benchmarking Frozen ***");
+    FrozenBenchmarks();
+
+    fmt::println("*** Benchmarking CompactJson ***");
+    CompactBenchmarks();
+
+    fmt::println("*** Benchmarking delta encoding ***");
+    DeltaBenchmarks();
+
+    fmt::println("*** Benchmarking SortNdjson ***");
+    SortNdjsonBenchmarks();
+
+    fmt::println("*** Benchmarking EditableJson ***");
+    EditableBenchmarks();
+
+    fmt::println("*** Benchmarking Visit ***");
+    VisitBenchmarks();
+
+    fmt::println("*** Benchmarking latency percentiles ***");
+    LatencyBenchmarks();
+
+    fmt::println("*** Benchmarking hardware counters ***");
+    PerfCounterBenchmarks();
+
+    fmt::println("-----------");
+    fmt::println("sink: {}", g_sink);
+  } catch (std::exception const& ex) {
+    fmt::println("    failed with info: {}", ex.what());
+    return 1;
+  }
+
+  return 0;
+}
@@ -1,5 +1,7 @@
 
 
+#include <sys/resource.h>
+
 import uzleo.json;
 import fmt;
 import std;
@@ -22,6 +24,11 @@ auto main() -> int {
     auto const& json_map{json.GetMap()};
     fmt::println("Welcome to {} v{}", json_map.at("app_name").GetStringView(),
                  json_map.at("version").GetDouble());
+
+    // compare with wsc_lite (BUILD_EMBEDDED)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    fmt::println("peak RSS {} KiB", usage.ru_maxrss);
   } catch (std::exception const& ex) {
     fmt::println("Caught exception: {}", ex.what());
     return 1;
@@ -0,0 +1,81 @@
+
+
+// weather-station client against uzleo.json.lite: built without exceptions,
+// fmt and heap allocations. Compare with `wsc` for binary size, peak RAM and
+// parse time.
+
+#include <sys/resource.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+
+import uzleo.json.lite;
+
+namespace chr = std::chrono;
+namespace lite = uzleo::json::lite;
+
+namespace {
+
+std::array<char, 1024> g_content{};
+lite::Document<64, 8> g_document{};
+
+/// @return kilobytes
+auto PeakResidentSetSize() -> long {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+}  // namespace
+
+auto main() -> int {
+  std::string_view const current_source_path{__FILE__};
+  std::array<char, 512> config_path{};
+  std::snprintf(config_path.data(), config_path.size(), "%.*s/config.json",
+                static_cast<int>(current_source_path.rfind('/')),
+                current_source_path.data());
+
+  auto* const file{std::fopen(config_path.data(), "rb")};
+  if (file == nullptr) {
+    std::printf("Failed to open %s\n", config_path.data());
+    return 1;
+  }
+  auto const size{std::fread(g_content.data(), 1, g_content.size(), file)};
+  std::fclose(file);
+  if (size == g_content.size()) {
+    std::printf("config.json exceeds %zu bytes\n", g_content.size());
+    return 1;
+  }
+
+  auto start_time_point{chr::steady_clock::now()};
+  auto const errc{g_document.Parse(std::string_view{g_content.data(), size})};
+  std::printf("Parse took %lldus\n",
+              static_cast<long long>(
+                  chr::duration_cast<chr::microseconds>(
+                      chr::steady_clock::now() - start_time_point)
+                      .count()));
+  if (errc != lite::Errc::kOk) {
+    auto const name{lite::ErrcName(errc)};
+    std::printf("Failed to parse config.json at byte %zu: %.*s\n",
+                g_document.ErrorOffset(), static_cast<int>(name.size()),
+                name.data());
+    return 1;
+  }
+
+  auto const root{g_document.Root()};
+  auto const app_name{root.GetJson("app_name").GetStringView()};
+  auto const version{root.GetJson("version").GetDouble()};
+  if (not app_name or not version) {
+    std::printf("config.json lacks app_name or version\n");
+    return 1;
+  }
+  std::printf("Welcome to %.*s v%g\n", static_cast<int>(app_name->size()),
+              app_name->data(), *version);
+  std::printf("document: %zu of 64 nodes, %zu bytes; peak RSS %ld KiB\n",
+              g_document.NodeCount(), sizeof(g_document),
+              PeakResidentSetSize());
+
+  return 0;
+}
@@ -1,6 +1,21 @@
 
 // SPDX-License-Identifier: MIT
 
+module;
+
+#if defined(__x86_64__) or defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) or defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <stdio.h>
+#endif
+
 export module uzleo.json;
 
 import std;
@@ -15,6 +30,10 @@ struct overloaded : Ts... {
   using Ts::operator()...;
 };
 
+}  // namespace
+
+namespace uzleo::json {
+
 enum class TokenType {
   kLeftBrace,
   kRightBrace,
@@ -76,22 +95,537 @@ auto format_as(Token const& token) -> std::string {
   }
 }
 
-}  // namespace
+/// hash used for object keys. This is constexpr so that hashes of known key
+/// names can be computed at compile-time.
+constexpr auto HashKey(std::string_view key) noexcept -> std::uint64_t {
+  constexpr std::uint64_t kMultiplier{0x9e3779b97f4a7c15};
 
-namespace uzleo::json {
+  auto const load{[key](std::size_t offset, std::size_t count) noexcept {
+    std::uint64_t word{0};
+    for (std::size_t i{0}; i < count; ++i) {
+      word |= std::uint64_t{static_cast<unsigned char>(key[offset + i])}
+              << (8 * i);
+    }
+    return word;
+  }};
+  auto const mix{[](std::uint64_t hash, std::uint64_t word) noexcept {
+    hash = (hash ^ word) * kMultiplier;
+    return hash ^ (hash >> 29);
+  }};
+
+  std::uint64_t hash{0xcbf29ce484222325 ^ rng::size(key)};
+  std::size_t offset{0};
+  for (; offset + 8 <= rng::size(key); offset += 8) {
+    hash = mix(hash, load(offset, 8));
+  }
+  if (offset < rng::size(key)) {
+    hash = mix(hash, load(offset, rng::size(key) - offset));
+  }
+
+  return mix(hash, hash >> 32);
+}
+
+/// object key with precomputed hash. Lookups with a Key skip hashing the key
+/// name, and for constant names the hash is computed at compile-time:
+///
+/// ```cpp
+/// static constexpr uzleo::json::Key kTimestamp{"timestamp"};
+/// auto const& timestamp{json.GetJson(kTimestamp)};
+/// ```
+///
+/// Key only views its name, so the name must outlive the Key.
+export class Key final {
+ public:
+  constexpr explicit Key(std::string_view name) noexcept
+      : m_name{name}, m_hash{HashKey(name)} {}
+
+  [[nodiscard]] constexpr auto Name() const noexcept -> std::string_view {
+    return m_name;
+  }
+  [[nodiscard]] constexpr auto Hash() const noexcept -> std::uint64_t {
+    return m_hash;
+  }
+
+ private:
+  std::string_view m_name;
+  std::uint64_t m_hash;
+};
+
+/// a group of control bytes of the open-addressing table used by ObjectMap.
+/// Each control byte is either kEmpty, kDeleted or holds the lower 7 bits of
+/// the hash of the entry stored in that slot. Matching a group yields a bitmask
+/// with one (or 8 for the portable variant) bit(s) per matching slot.
+class ControlGroup final {
+ public:
+  static constexpr std::uint8_t kEmpty{0x80};
+  static constexpr std::uint8_t kDeleted{0xfe};
+
+#if defined(__SSE2__)
+  using mask_t = std::uint32_t;
+  static constexpr std::size_t kWidth{16};
+  static constexpr int kMaskShift{0};
+
+  explicit ControlGroup(std::uint8_t const* ctrl) noexcept
+      : m_ctrl{_mm_loadu_si128(reinterpret_cast<__m128i const*>(ctrl))} {}
+
+  [[nodiscard]] auto Match(std::uint8_t h2) const noexcept -> mask_t {
+    return static_cast<mask_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(static_cast<char>(h2)))));
+  }
+
+  [[nodiscard]] auto MatchEmpty() const noexcept -> mask_t {
+    return Match(kEmpty);
+  }
+
+  [[nodiscard]] auto MatchEmptyOrDeleted() const noexcept -> mask_t {
+    return static_cast<mask_t>(_mm_movemask_epi8(m_ctrl));
+  }
+
+ private:
+  __m128i m_ctrl;
+#else
+  using mask_t = std::uint64_t;
+  static constexpr std::size_t kWidth{8};
+  static constexpr int kMaskShift{3};
+
+  explicit constexpr ControlGroup(std::uint8_t const* ctrl) noexcept {
+    for (std::size_t i{0}; i < kWidth; ++i) {
+      m_ctrl |= std::uint64_t{ctrl[i]} << (8 * i);
+    }
+  }
+
+  /// can report false positives for full slots following a true match, but
+  /// never for empty or deleted slots. Callers compare keys anyway.
+  [[nodiscard]] constexpr auto Match(std::uint8_t h2) const noexcept
+      -> mask_t {
+    auto const value{m_ctrl ^ (kLsbs * h2)};
+    return (value - kLsbs) & ~value & kMsbs;
+  }
+
+  [[nodiscard]] constexpr auto MatchEmpty() const noexcept -> mask_t {
+    return m_ctrl & ~(m_ctrl << 6) & kMsbs;
+  }
+
+  [[nodiscard]] constexpr auto MatchEmptyOrDeleted() const noexcept
+      -> mask_t {
+    return m_ctrl & kMsbs;
+  }
+
+ private:
+  static constexpr std::uint64_t kLsbs{0x0101010101010101};
+  static constexpr std::uint64_t kMsbs{0x8080808080808080};
+
+  std::uint64_t m_ctrl{0};
+#endif
+};
+
+/// insertion-ordered hash map used as json object representation.
+///
+/// Entries live densely in a vector (cheap iteration, no node per entry).
+/// Small objects are searched linearly; once an object grows beyond
+/// kLinearScanLimit members, an open-addressing index (swiss-table style
+/// control bytes probed a group at a time) is built over the entries. Growing
+/// the index only shuffles 32-bit entry indices, never the values themselves.
+///
+/// Alternatively the entries can be kept sorted by key (see SortedFrom()), in
+/// which case no index is built and lookups are binary searches. This layout
+/// gives deterministic iteration order and allows linear merges of two maps.
+///
+/// The API mirrors the subset of std::unordered_map that is useful for json
+/// objects, with heterogeneous (std::string_view) lookup.
+template <class V>
+class ObjectMap final {
+ public:
+  using key_type = std::string;
+  using mapped_type = V;
+  using value_type = std::pair<std::string, V>;
+  using size_type = std::size_t;
+  using const_iterator = std::vector<value_type>::const_iterator;
+  using iterator = const_iterator;
+
+  static constexpr std::size_t kNpos{std::numeric_limits<std::size_t>::max()};
+  static constexpr std::size_t kLinearScanLimit{8};
+
+  constexpr ObjectMap() = default;
+  constexpr ObjectMap(ObjectMap&& other) noexcept
+      : m_entries{std::move(other.m_entries)},
+        m_table{std::move(other.m_table)},
+        m_capacity{std::exchange(other.m_capacity, 0)},
+        m_growth_left{std::exchange(other.m_growth_left, 0)} {
+    other.m_entries.clear();
+  }
+  constexpr auto operator=(ObjectMap&& other) noexcept -> ObjectMap& {
+    if (this != &other) {
+      m_entries = std::move(other.m_entries);
+      m_table = std::move(other.m_table);
+      m_capacity = std::exchange(other.m_capacity, 0);
+      m_growth_left = std::exchange(other.m_growth_left, 0);
+      other.m_entries.clear();
+    }
+    return *this;
+  }
+  constexpr ~ObjectMap() = default;
+  ObjectMap(ObjectMap const&) = delete;
+  ObjectMap& operator=(ObjectMap const&) = delete;
+
+  /// creates a map in sorted layout. For duplicate keys the first entry wins.
+  [[nodiscard]] static constexpr auto SortedFrom(
+      std::vector<value_type>&& entries) -> ObjectMap {
+    static constexpr auto key_projection{
+        [](value_type const& entry) -> std::string const& {
+          return entry.first;
+        }};
+
+    ObjectMap object_map{};
+    object_map.m_entries = std::move(entries);
+    if (not rng::is_sorted(object_map.m_entries, {}, key_projection)) {
+      rng::stable_sort(object_map.m_entries, {}, key_projection);
+    }
+    auto const duplicates{rng::unique(object_map.m_entries, {}, key_projection)};
+    object_map.m_entries.erase(rng::begin(duplicates), rng::end(duplicates));
+    object_map.m_growth_left = kSorted;
+    return object_map;
+  }
+
+  /// switches this map to sorted layout
+  constexpr auto SortByKey() -> void {
+    if (not IsSorted()) {
+      auto entries{std::move(*this).ExtractEntries()};
+      *this = SortedFrom(std::move(entries));
+    }
+  }
+
+  [[nodiscard]] constexpr auto IsSorted() const noexcept -> bool {
+    return m_capacity == 0 and m_growth_left == kSorted;
+  }
+
+  /// moves all entries out, leaving this map empty
+  [[nodiscard]] constexpr auto ExtractEntries() && -> std::vector<value_type> {
+    auto entries{std::move(m_entries)};
+    clear();
+    return entries;
+  }
+
+  [[nodiscard]] constexpr auto begin() const noexcept -> const_iterator {
+    return rng::cbegin(m_entries);
+  }
+  [[nodiscard]] constexpr auto end() const noexcept -> const_iterator {
+    return rng::cend(m_entries);
+  }
+  [[nodiscard]] constexpr auto size() const noexcept -> size_type {
+    return rng::size(m_entries);
+  }
+  [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+    return rng::empty(m_entries);
+  }
+
+  constexpr auto clear() noexcept -> void {
+    m_entries.clear();
+    m_table.reset();
+    m_capacity = 0;
+    m_growth_left = 0;
+  }
+
+  constexpr auto reserve(size_type count) -> void {
+    m_entries.reserve(count);
+    if (not IsSorted() and count > kLinearScanLimit and
+        count > Capacity(m_capacity)) {
+      Rehash(count);
+    }
+  }
+
+  /// @return index of the entry with given key, kNpos if there is none
+  [[nodiscard]] constexpr auto IndexOf(std::string_view key,
+                                       std::uint64_t hash) const noexcept
+      -> std::size_t {
+    if (IsSorted()) {
+      auto const citer{LowerBound(key)};
+      return (citer != end() and citer->first == key)
+                 ? static_cast<std::size_t>(rng::distance(begin(), citer))
+                 : kNpos;
+    }
+    if (m_capacity == 0) {
+      for (std::size_t index{0}; index < rng::size(m_entries); ++index) {
+        if (m_entries[index].first == key) {
+          return index;
+        }
+      }
+      return kNpos;
+    }
+
+    auto const h2{static_cast<std::uint8_t>(hash & 0x7f)};
+    auto const group_mask{std::size_t{m_capacity} / ControlGroup::kWidth - 1};
+    auto group{(hash >> 7) & group_mask};
+    for (std::size_t probe{1};; ++probe) {
+      ControlGroup const ctrl_group{Control() + group * ControlGroup::kWidth};
+      for (auto mask{ctrl_group.Match(h2)}; mask != 0; mask &= mask - 1) {
+        auto const slot{group * ControlGroup::kWidth +
+                        (std::countr_zero(mask) >> ControlGroup::kMaskShift)};
+        if (auto const index{Slots()[slot]}; m_entries[index].first == key) {
+          return index;
+        }
+      }
+      if (ctrl_group.MatchEmpty() != 0) {
+        return kNpos;
+      }
+      // triangular probing visits every group as group count is a power of 2
+      group = (group + probe) & group_mask;
+    }
+  }
+
+  [[nodiscard]] constexpr auto IndexOf(std::string_view key) const noexcept
+      -> std::size_t {
+    if (m_capacity == 0) {
+      return IndexOf(key, 0);
+    }
+    return IndexOf(key, HashKey(key));
+  }
+
+  [[nodiscard]] constexpr auto find(std::string_view key) const noexcept
+      -> const_iterator {
+    auto const index{IndexOf(key)};
+    return index == kNpos ? end() : rng::next(begin(), index);
+  }
+
+  [[nodiscard]] constexpr auto find(Key const& key) const noexcept
+      -> const_iterator {
+    auto const index{IndexOf(key.Name(), key.Hash())};
+    return index == kNpos ? end() : rng::next(begin(), index);
+  }
+
+  [[nodiscard]] constexpr auto contains(std::string_view key) const noexcept
+      -> bool {
+    return IndexOf(key) != kNpos;
+  }
+
+  [[nodiscard]] constexpr auto at(std::string_view key) const -> V const& {
+    auto const index{IndexOf(key)};
+    if (index == kNpos) {
+      throw std::out_of_range{"json object does not contain key."};
+    }
+    return m_entries[index].second;
+  }
+
+  [[nodiscard]] constexpr auto at(std::string_view key) -> V& {
+    return const_cast<V&>(std::as_const(*this).at(key));
+  }
+
+  /// inserts value with given key if the key is not present yet
+  template <class... Args>
+  constexpr auto try_emplace(std::string_view key, Args&&... args)
+      -> std::pair<iterator, bool> {
+    auto const hash{HashKey(key)};
+    if (auto const index{IndexOf(key, hash)}; index != kNpos) {
+      return {rng::next(begin(), index), false};
+    }
+
+    if (IsSorted()) {
+      return {m_entries.emplace(LowerBound(key), std::piecewise_construct,
+                                std::forward_as_tuple(key),
+                                std::forward_as_tuple(
+                                    std::forward<Args>(args)...)),
+              true};
+    }
+
+    PrepareInsert();
+    m_entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+    if (m_capacity != 0) {
+      IndexEntry(hash, rng::size(m_entries) - 1);
+    }
+    return {rng::prev(end()), true};
+  }
+
+  constexpr auto emplace(std::string key, V&& value)
+      -> std::pair<iterator, bool> {
+    return try_emplace(key, std::move(value));
+  }
+
+  constexpr auto insert_or_assign(std::string_view key, V&& value)
+      -> std::pair<iterator, bool> {
+    auto result{try_emplace(key, std::move(value))};
+    if (not result.second) {
+      m_entries[static_cast<std::size_t>(
+                    rng::distance(begin(), result.first))]
+          .second = std::move(value);
+    }
+    return result;
+  }
+
+  /// removes entry with given key. Unless the map is sorted, the last entry
+  /// takes the place of the removed one.
+  /// @return number of removed entries
+  constexpr auto erase(std::string_view key) -> size_type {
+    auto const hash{HashKey(key)};
+    auto const index{IndexOf(key, hash)};
+    if (index == kNpos) {
+      return 0;
+    }
+    if (IsSorted()) {
+      m_entries.erase(rng::next(rng::begin(m_entries), index));
+      return 1;
+    }
+
+    auto const last{rng::size(m_entries) - 1};
+    if (m_capacity != 0) {
+      SetControl(SlotOf(hash, index), ControlGroup::kDeleted);
+      if (index != last) {
+        Slots()[SlotOf(HashKey(m_entries[last].first), last)] =
+            static_cast<std::uint32_t>(index);
+      }
+    }
+    if (index != last) {
+      m_entries[index] = std::move(m_entries[last]);
+    }
+    m_entries.pop_back();
+    return 1;
+  }
+
+  /// compares entries (order independent). Two sorted maps are compared with
+  /// a single linear pass.
+  [[nodiscard]] friend constexpr auto operator==(ObjectMap const& lhs,
+                                                 ObjectMap const& rhs)
+      -> bool {
+    if (rng::size(lhs) != rng::size(rhs)) {
+      return false;
+    }
+    if (lhs.IsSorted() and rhs.IsSorted()) {
+      return lhs.m_entries == rhs.m_entries;
+    }
+
+    return rng::all_of(lhs, [&rhs](value_type const& entry) {
+      auto const citer{rhs.find(entry.first)};
+      return citer != rng::cend(rhs) and citer->second == entry.second;
+    });
+  }
+
+ private:
+  /// marker stored in m_growth_left for maps in sorted layout
+  static constexpr std::uint32_t kSorted{
+      std::numeric_limits<std::uint32_t>::max()};
+
+  [[nodiscard]] constexpr auto LowerBound(std::string_view key) const noexcept
+      -> const_iterator {
+    return rng::lower_bound(
+        m_entries, key, {},
+        [](value_type const& entry) -> std::string_view {
+          return entry.first;
+        });
+  }
+
+  /// max number of entries that a table of given capacity can hold (7/8)
+  [[nodiscard]] static constexpr auto Capacity(std::size_t slot_count) noexcept
+      -> std::uint32_t {
+    return static_cast<std::uint32_t>(slot_count - slot_count / 8);
+  }
+
+  [[nodiscard]] constexpr auto Slots() const noexcept -> std::uint32_t* {
+    return m_table.get();
+  }
+
+  /// control bytes are stored right after the slots in the same allocation
+  [[nodiscard]] constexpr auto Control() const noexcept -> std::uint8_t* {
+    return reinterpret_cast<std::uint8_t*>(m_table.get() + m_capacity);
+  }
+
+  constexpr auto SetControl(std::size_t slot, std::uint8_t value) noexcept
+      -> void {
+    Control()[slot] = value;
+  }
+
+  /// @return slot of the index table that refers to entry at given index
+  [[nodiscard]] constexpr auto SlotOf(std::uint64_t hash,
+                                      std::size_t index) const noexcept
+      -> std::size_t {
+    auto const h2{static_cast<std::uint8_t>(hash & 0x7f)};
+    auto const group_mask{std::size_t{m_capacity} / ControlGroup::kWidth - 1};
+    auto group{(hash >> 7) & group_mask};
+    for (std::size_t probe{1};; ++probe) {
+      ControlGroup const ctrl_group{Control() + group * ControlGroup::kWidth};
+      for (auto mask{ctrl_group.Match(h2)}; mask != 0; mask &= mask - 1) {
+        auto const slot{group * ControlGroup::kWidth +
+                        (std::countr_zero(mask) >> ControlGroup::kMaskShift)};
+        if (Slots()[slot] == index) {
+          return slot;
+        }
+      }
+      group = (group + probe) & group_mask;
+    }
+  }
+
+  constexpr auto IndexEntry(std::uint64_t hash, std::size_t index) noexcept
+      -> void {
+    auto const group_mask{std::size_t{m_capacity} / ControlGroup::kWidth - 1};
+    auto group{(hash >> 7) & group_mask};
+    for (std::size_t probe{1};; ++probe) {
+      ControlGroup const ctrl_group{Control() + group * ControlGroup::kWidth};
+      if (auto const mask{ctrl_group.MatchEmptyOrDeleted()}; mask != 0) {
+        auto const slot{group * ControlGroup::kWidth +
+                        (std::countr_zero(mask) >> ControlGroup::kMaskShift)};
+        if (Control()[slot] == ControlGroup::kEmpty) {
+          --m_growth_left;
+        }
+        SetControl(slot, static_cast<std::uint8_t>(hash & 0x7f));
+        Slots()[slot] = static_cast<std::uint32_t>(index);
+        return;
+      }
+      group = (group + probe) & group_mask;
+    }
+  }
+
+  /// makes sure that one more entry can be indexed
+  constexpr auto PrepareInsert() -> void {
+    auto const new_size{rng::size(m_entries) + 1};
+    if (m_capacity == 0) {
+      if (new_size > kLinearScanLimit) {
+        Rehash(new_size);
+      }
+    } else if (m_growth_left == 0) {
+      Rehash(new_size);
+    }
+  }
+
+  /// rebuilds the index table for at least `count` entries. This also drops
+  /// all deleted slots.
+  constexpr auto Rehash(std::size_t count) -> void {
+    auto slot_count{
+        std::max(ControlGroup::kWidth, std::bit_ceil(count + count / 7 + 1))};
+    while (Capacity(slot_count) < count) {
+      slot_count *= 2;
+    }
+
+    m_table = std::make_unique_for_overwrite<std::uint32_t[]>(slot_count +
+                                                              slot_count / 4);
+    m_capacity = static_cast<std::uint32_t>(slot_count);
+    m_growth_left = Capacity(slot_count);
+    std::fill_n(Control(), slot_count, ControlGroup::kEmpty);
+    for (std::size_t index{0}; index < rng::size(m_entries); ++index) {
+      IndexEntry(HashKey(m_entries[index].first), index);
+    }
+  }
+
+  std::vector<value_type> m_entries{};
+  /// slots (entry indices) followed by control bytes; null in linear mode
+  std::unique_ptr<std::uint32_t[]> m_table{};
+  std::uint32_t m_capacity{0};
+  std::uint32_t m_growth_left{0};
+};
 
 export class Json final {
  public:
-  using json_object_t = std::unordered_map<std::string, Json>;
+  using json_object_t = ObjectMap<Json>;
   using json_array_t = std::vector<Json>;
+  /// binary payload, dumped as a base64 string
+  using json_blob_t = std::vector<std::byte>;
 
   constexpr explicit Json(bool value) : m_value{value} {}
   constexpr explicit Json(double value) : m_value{value} {}
   constexpr explicit Json(std::monostate monostate) : m_value{monostate} {}
   constexpr explicit Json(std::string_view value)
-      : m_value{std::string(value)} {}
+      : m_value{json_string_t{std::string(value)}} {}
   constexpr explicit Json(json_object_t&& value) : m_value{std::move(value)} {}
   constexpr explicit Json(json_array_t&& value) : m_value{std::move(value)} {}
+  constexpr explicit Json(json_blob_t&& value) : m_value{std::move(value)} {}
 
   constexpr Json(Json&& other) = default;
   constexpr Json& operator=(Json&& other) = default;
@@ -99,8 +633,9 @@ export class Json final {
   Json(Json const&) = delete;
   Json& operator=(Json const&) = delete;
 
-  /// formats the internal json representation into a string
-  constexpr auto Dump() const { return fmt::format("{}", *this); }
+  /// formats the internal json representation into a string, same as
+  /// fmt::format("{}", json). See fmt::formatter<Json> for other layouts.
+  [[nodiscard]] constexpr auto Dump() const -> std::string;
 
   /// check if the json object contains a specific key
   /// @return true if key exists, false otherwise
@@ -110,22 +645,56 @@ export class Json final {
       throw std::logic_error{"json is not an object."};
     }
 
-    return std::get<json_object_t>(m_value).contains(std::string{key});
+    return std::get<json_object_t>(m_value).contains(key);
+  }
+
+  /// same as Contains(std::string_view) but without hashing the key
+  [[nodiscard]] constexpr auto Contains(Key const& key) const -> bool {
+    if (not std::holds_alternative<json_object_t>(m_value)) {
+      throw std::logic_error{"json is not an object."};
+    }
+
+    auto const& json_object{std::get<json_object_t>(m_value)};
+    return json_object.find(key) != rng::cend(json_object);
   }
 
   template <class T>
   [[nodiscard]] constexpr auto IsType() const -> bool {
-    return std::holds_alternative<T>(m_value);
+    if constexpr (std::same_as<T, std::string>) {
+      return std::holds_alternative<json_string_t>(m_value);
+    } else {
+      return std::holds_alternative<T>(m_value);
+    }
   }
 
+  /// @return the string as written in the json text, i.e. still escaped
   [[nodiscard]] constexpr auto GetStringView() const -> std::string_view {
     if (not IsType<std::string>()) {
       throw std::invalid_argument{"does not contain string value."};
     }
 
-    return std::string_view{std::get<std::string>(m_value)};
+    return std::string_view{std::get<json_string_t>(m_value).value};
   }
 
+  /// parses a string value that itself holds a json document, e.g. an event
+  /// `{"payload": "{\"id\": 1}"}`. The string is unescaped straight into a
+  /// reused lexer buffer and the resulting subtree is cached in this
+  /// instance, so repeated calls do not parse again. Concurrent calls on the
+  /// same instance may each parse, but all get the one cached subtree.
+  /// @throws std::invalid_argument if not a string value or if the string
+  /// holds no tokens
+  /// @throws std::runtime_error/std::logic_error if the string holds
+  /// malformed json
+  [[nodiscard]] constexpr auto GetEmbeddedJson() const -> Json const&;
+
+  /// @return the bytes of a blob value, or the base64 decoded bytes of a
+  /// string value. The latter are decoded into buffer, which is resized as
+  /// needed and can be reused across calls to avoid allocations.
+  /// @throws std::invalid_argument if neither a blob nor a string value, or if
+  /// the string is not valid base64
+  [[nodiscard]] constexpr auto GetBytes(std::vector<std::byte>& buffer) const
+      -> std::span<std::byte const>;
+
   [[nodiscard]] constexpr auto GetDouble() const -> double {
     if (not IsType<double>()) {
       throw std::invalid_argument{"does not contain double value."};
@@ -142,7 +711,7 @@ export class Json final {
     return std::get<json_array_t>(m_value);
   }
 
-  [[nodiscard]] constexpr auto GetMap() const -> json_object_t const& {
+  [[nodiscard]] constexpr auto GetMap() const& -> json_object_t const& {
     if (not IsType<json_object_t>()) {
       throw std::invalid_argument{"does not contain map value."};
     }
@@ -150,376 +719,5409 @@ export class Json final {
     return std::get<json_object_t>(m_value);
   }
 
+  /// moves the map value out of this json instance
+  [[nodiscard]] constexpr auto GetMap() && -> json_object_t {
+    if (not IsType<json_object_t>()) {
+      throw std::invalid_argument{"does not contain map value."};
+    }
+
+    return std::move(std::get<json_object_t>(m_value));
+  }
+
   [[nodiscard]] constexpr auto GetJson(std::string_view key) const
       -> Json const& {
-    if (not Contains(key)) {
+    if (not IsType<json_object_t>()) {
+      throw std::logic_error{"json is not an object."};
+    }
+
+    auto const& json_object{std::get<json_object_t>(m_value)};
+    auto const citer{json_object.find(key)};
+    if (citer == rng::cend(json_object)) {
       throw std::invalid_argument{fmt::format("does not contain {} key.", key)};
     }
+
+    return citer->second;
+  }
+
+  /// same as GetJson(std::string_view) but without hashing the key
+  [[nodiscard]] constexpr auto GetJson(Key const& key) const -> Json const& {
     if (not IsType<json_object_t>()) {
-      throw std::invalid_argument{"is not a json map object."};
+      throw std::logic_error{"json is not an object."};
     }
 
-    return std::get<json_object_t>(m_value).at(std::string{key});
+    auto const& json_object{std::get<json_object_t>(m_value)};
+    auto const citer{json_object.find(key)};
+    if (citer == rng::cend(json_object)) {
+      throw std::invalid_argument{
+          fmt::format("does not contain {} key.", key.Name())};
+    }
+
+    return citer->second;
   }
 
  private:
-  struct json_value_t : std::variant<bool, double, std::monostate, std::string,
-                                     json_object_t, json_array_t> {
+  /// raw (escaped) string plus the lazily parsed json it may embed
+  struct json_string_t {
+    constexpr explicit json_string_t(std::string&& string) noexcept
+        : value{std::move(string)} {}
+    constexpr json_string_t(json_string_t&& other) noexcept
+        : value{std::move(other.value)},
+          embedded{
+              other.embedded.exchange(nullptr, std::memory_order_relaxed)} {}
+    constexpr auto operator=(json_string_t&& other) noexcept
+        -> json_string_t& {
+      value = std::move(other.value);
+      delete embedded.exchange(
+          other.embedded.exchange(nullptr, std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      return *this;
+    }
+    constexpr ~json_string_t() {
+      delete embedded.load(std::memory_order_relaxed);
+    }
+
+    std::string value;
+    /// owned; set once by GetEmbeddedJson(), which may run concurrently on a
+    /// const instance
+    mutable std::atomic<Json*> embedded{nullptr};
+
+    [[nodiscard]] friend constexpr auto operator==(json_string_t const& lhs,
+                                                   json_string_t const& rhs)
+        -> bool {
+      return lhs.value == rhs.value;
+    }
+  };
+
+  struct json_value_t
+      : std::variant<bool, double, std::monostate, json_string_t,
+                     json_object_t, json_array_t, json_blob_t> {
     using variant::variant;
   };
 
   json_value_t m_value;
 
-  friend constexpr auto format_as(Json const& json) -> std::string;
+  /// deep comparison. Objects are compared irrespective of member order.
+  [[nodiscard]] friend constexpr auto operator==(Json const& lhs,
+                                                 Json const& rhs) -> bool {
+    return lhs.m_value == rhs.m_value;
+  }
+
+  friend class JsonWriter;
+  friend class CompactJson;
+  friend class DeltaDecoder;
+  friend class EditableJson;
 };
 
-constexpr auto format_as(Json const& json) -> std::string {
-  using namespace std::string_literals;
+/// lookup of a single key that remembers at which member index the key was
+/// found last time (an inline cache). When iterating same-shaped objects, e.g.
+/// records of an array, the remembered index almost always hits and the
+/// lookup is a single key comparison. On a miss, it falls back to a regular
+/// lookup and remembers the new index.
+///
+/// ```cpp
+/// uzleo::json::CachedLookup temp{"temp"};
+/// for (auto const& record : json.GetArray()) {
+///   sum += temp.Get(record).GetDouble();
+/// }
+/// ```
+///
+/// The cache is mutated on every lookup, so use one instance per callsite
+/// and thread.
+export class CachedLookup final {
+ public:
+  constexpr explicit CachedLookup(std::string_view name) noexcept
+      : m_key{name} {}
+  constexpr explicit CachedLookup(Key const& key) noexcept : m_key{key} {}
 
-  return std::visit(
-      overloaded{
-          []([[maybe_unused]] std::monostate monostate) { return "null"s; },
-          [](bool value) { return fmt::format("{}", value); },
-          [](std::string const& value) { return fmt::format("\"{}\"", value); },
-          [](double value) { return fmt::format("{}", value); },
-          [](Json::json_object_t const& value) {
-            std::string result = "{";
-            bool first{true};
-            for (auto const& [key, val] : value) {
-              if (!first) result += ", ";
-              result += fmt::format("\"{}\": {}", key, format_as(val));
-              first = false;
-            }
-            result += "}";
-            return result;
-          },
-          [](Json::json_array_t const& value) {
-            std::string result = "[";
-            bool first{true};
-            for (auto const& val : value) {
-              if (!first) result += ", ";
-              result += format_as(val);
-              first = false;
-            }
-            result += "]";
-            return result;
-          }},
-      json.m_value);
-}
+  /// @return pointer to the member value, nullptr if there is no such member
+  /// @throws std::logic_error if called on a non-object json instance
+  [[nodiscard]] constexpr auto Find(Json const& json) -> Json const* {
+    if (not json.IsType<Json::json_object_t>()) {
+      throw std::logic_error{"json is not an object."};
+    }
 
-/// this allocates the string buffer (holding json) data on heap so that it is
-/// alive throughout the program. This allows views over it to be used for
-/// lex/parse algorithms
-constexpr auto ReadFile(std::filesystem::path&& absolute_file_path)
-    -> std::shared_ptr<std::string const> {
-  if (not std::filesystem::exists(absolute_file_path)) {
-    throw std::invalid_argument{
-        fmt::format("Json {} file does not exist.", absolute_file_path)};
+    auto const& json_object{json.GetMap()};
+    if (m_index < rng::size(json_object)) {
+      if (auto const& [key, value]{*rng::next(rng::cbegin(json_object),
+                                              m_index)};
+          key == m_key.Name()) {
+        return &value;
+      }
+    }
+
+    auto const index{json_object.IndexOf(m_key.Name(), m_key.Hash())};
+    if (index == Json::json_object_t::kNpos) {
+      return nullptr;
+    }
+    m_index = index;
+    return &rng::next(rng::cbegin(json_object), index)->second;
   }
-  std::ifstream file_stream{absolute_file_path};
-  if (not file_stream.is_open()) {
-    throw std::runtime_error{
-        fmt::format("Failed to open json {} file.", absolute_file_path)};
+
+  /// @throws std::invalid_argument if member does not exist
+  /// @throws std::logic_error if called on a non-object json instance
+  [[nodiscard]] constexpr auto Get(Json const& json) -> Json const& {
+    if (auto const* value{Find(json)}; value != nullptr) {
+      return *value;
+    }
+    throw std::invalid_argument{
+        fmt::format("does not contain {} key.", m_key.Name())};
   }
 
-  return std::make_shared<std::string const>(
-      rng::istream_view<char>{file_stream} | rng::to<std::string>());
-}
+ private:
+  Key m_key;
+  std::size_t m_index{0};
+};
 
-constexpr auto Lex(std::shared_ptr<std::string const>&& json_content_ptr)
-    -> std::tuple<std::shared_ptr<std::string const>, TokenStream> {
-  static constexpr auto in_number{[](char value) noexcept {
-    return (std::isdigit(value) or value == '-' or value == '.' or
-            value == 'e');
-  }};
+/// optional reference to a member value, as returned by GetMany()
+export using JsonRef = std::optional<std::reference_wrapper<Json const>>;
 
-  auto const& json_content{*json_content_ptr};
-  auto const json_content_end_iter{rng::cend(json_content)};
+template <class>
+using json_ref_for_t = JsonRef;
 
-  TokenStream token_stream{};
-  token_stream.reserve(100);
+/// resolves several members of an object at once. Small (linearly searched)
+/// objects are scanned a single time for all keys; larger objects are probed
+/// per key, reusing the precomputed hash of Key arguments.
+///
+/// ```cpp
+/// auto [timestamp, value]{uzleo::json::GetMany(json, "timestamp", kValue)};
+/// if (value) { use(value->get().GetDouble()); }
+/// ```
+///
+/// @param keys std::string_view convertible names or Key instances
+/// @throws std::invalid_argument if called on a non-object json instance
+export template <class... Keys>
+[[nodiscard]] constexpr auto GetMany(Json const& json, Keys const&... keys)
+    -> std::tuple<json_ref_for_t<Keys>...> {
+  static constexpr auto kKeyCount{sizeof...(Keys)};
 
-  auto citer{rng::cbegin(json_content)};
-  while (citer != json_content_end_iter) {
-    switch (std::string_view tmp_view{citer, json_content_end_iter}; *citer) {
-      case '{': {
-        token_stream.emplace_back(TokenType::kLeftBrace);
+  auto const& json_object{json.GetMap()};
+  std::array<Json const*, kKeyCount> values{};
 
-        rng::advance(citer, 1, json_content_end_iter);
-        break;
+  if (not json_object.IsSorted() and
+      rng::size(json_object) <= Json::json_object_t::kLinearScanLimit) {
+    std::array<std::string_view, kKeyCount> const names{[](auto const& key) {
+      if constexpr (std::same_as<std::remove_cvref_t<decltype(key)>, Key>) {
+        return key.Name();
+      } else {
+        return std::string_view{key};
       }
-      case '}': {
-        token_stream.emplace_back(TokenType::kRightBrace);
+    }(keys)...};
 
-        rng::advance(citer, 1, json_content_end_iter);
+    auto remaining{kKeyCount};
+    for (auto const& [key, value] : json_object) {
+      for (std::size_t index{0}; index < kKeyCount; ++index) {
+        if (values[index] == nullptr and names[index] == key) {
+          values[index] = &value;
+          --remaining;
+        }
+      }
+      if (remaining == 0) {
         break;
       }
-      case 'f': {
-        if (tmp_view.starts_with("false")) {
-          token_stream.emplace_back(TokenType::kFalse, tmp_view.substr(0, 5));
+    }
+  } else {
+    values = {[&json_object](auto const& key) -> Json const* {
+      auto const citer{[&] {
+        if constexpr (std::same_as<std::remove_cvref_t<decltype(key)>, Key>) {
+          return json_object.find(key);
+        } else {
+          return json_object.find(std::string_view{key});
+        }
+      }()};
+      return citer == rng::cend(json_object) ? nullptr : &citer->second;
+    }(keys)...};
+  }
+
+  return [&values]<std::size_t... Is>(std::index_sequence<Is...>) {
+    return std::tuple<json_ref_for_t<Keys>...>{
+        values[Is] == nullptr ? JsonRef{} : JsonRef{std::cref(*values[Is])}...};
+  }(std::index_sequence_for<Keys...>{});
+}
+
+/// @return number of base64 characters, padding included, for byte_count
+/// bytes
+[[nodiscard]] constexpr auto Base64EncodedSize(std::size_t byte_count) noexcept
+    -> std::size_t {
+  return (byte_count + 2) / 3 * 4;
+}
+
+/// encodes input as base64 into exactly Base64EncodedSize() characters
+auto Base64Encode(std::span<std::byte const> input,
+                  std::span<char> output) noexcept -> void;
+
+/// layout of serialized json
+struct WriteStyle {
+  std::string_view item_separator{", "};
+  std::string_view key_separator{": "};
+  /// spaces per nesting level, each member/element on its own line; 0 keeps
+  /// everything on one line
+  std::size_t indent{0};
+};
+
+/// serializes a json piece by piece into a sink, i.e. any callable taking
+/// std::string_view, so that large documents need not be held as one string.
+/// With the default style it produces the same text as Dump(). A sink with a
+/// `Done()` member returning true ends serialization early.
+class JsonWriter final {
+ public:
+  template <class Sink>
+  static constexpr auto Write(Json const& json, Sink& sink,
+                              WriteStyle const& style = {},
+                              std::size_t depth = 0) -> void {
+    if (IsDone(sink)) {
+      return;
+    }
+
+    std::visit(
+        overloaded{
+            [&sink]([[maybe_unused]] std::monostate monostate) {
+              sink("null");
+            },
+            [&sink](bool value) { sink(value ? "true" : "false"); },
+            [&sink](Json::json_string_t const& value) {
+              sink("\"");
+              sink(value.value);
+              sink("\"");
+            },
+            [&sink](double value) {
+              // shortest round-trip representation of a double fits in 24
+              std::array<char, 32> digits;
+              auto const result{fmt::format_to_n(rng::data(digits),
+                                                 rng::size(digits), "{}",
+                                                 value)};
+              sink(std::string_view{rng::data(digits), result.out});
+            },
+            [&sink, &style, depth](Json::json_object_t const& value) {
+              if (rng::empty(value)) {
+                sink("{}");
+                return;
+              }
+              sink("{");
+              bool first{true};
+              for (auto const& [key, val] : value) {
+                if (IsDone(sink)) {
+                  return;
+                }
+                if (not first) {
+                  sink(style.item_separator);
+                }
+                NewLine(sink, style, depth + 1);
+                sink("\"");
+                sink(key);
+                sink("\"");
+                sink(style.key_separator);
+                Write(val, sink, style, depth + 1);
+                first = false;
+              }
+              NewLine(sink, style, depth);
+              sink("}");
+            },
+            [&sink, &style, depth](Json::json_array_t const& value) {
+              if (rng::empty(value)) {
+                sink("[]");
+                return;
+              }
+              sink("[");
+              bool first{true};
+              for (auto const& val : value) {
+                if (IsDone(sink)) {
+                  return;
+                }
+                if (not first) {
+                  sink(style.item_separator);
+                }
+                NewLine(sink, style, depth + 1);
+                Write(val, sink, style, depth + 1);
+                first = false;
+              }
+              NewLine(sink, style, depth);
+              sink("]");
+            },
+            [&sink](Json::json_blob_t const& value) {
+              // encoded in chunks of whole 3 byte groups
+              static constexpr std::size_t kChunkSize{3 * 1024};
+              std::array<char, Base64EncodedSize(kChunkSize)> encoded;
+              sink("\"");
+              for (std::size_t offset{0};
+                   offset < rng::size(value) and not IsDone(sink);
+                   offset += kChunkSize) {
+                auto const chunk{std::span{value}.subspan(
+                    offset, std::min(kChunkSize, rng::size(value) - offset))};
+                auto const encoded_size{Base64EncodedSize(rng::size(chunk))};
+                Base64Encode(chunk, std::span{encoded}.first(encoded_size));
+                sink(std::string_view{rng::data(encoded), encoded_size});
+              }
+              sink("\"");
+            }},
+        json.m_value);
+  }
+
+ private:
+  template <class Sink>
+  [[nodiscard]] static constexpr auto IsDone(Sink const& sink) -> bool {
+    if constexpr (requires {
+                    { sink.Done() } -> std::convertible_to<bool>;
+                  }) {
+      return sink.Done();
+    } else {
+      return false;
+    }
+  }
+
+  template <class Sink>
+  static constexpr auto NewLine(Sink& sink, WriteStyle const& style,
+                                std::size_t depth) -> void {
+    static constexpr std::string_view kSpaces{
+        "                                "};
+
+    if (style.indent == 0) {
+      return;
+    }
+    sink("\n");
+    for (auto remaining{style.indent * depth}; remaining > 0;) {
+      auto const space_count{std::min(remaining, rng::size(kSpaces))};
+      sink(kSpaces.substr(0, space_count));
+      remaining -= space_count;
+    }
+  }
+};
+
+/// forwards the output to the wrapped sink if it fits into max_size bytes,
+/// otherwise a prefix of it followed by marker, max_size bytes in total.
+/// Reports Done() once the limit is hit, so JsonWriter stops serializing.
+/// The last bytes before the limit are held back until Finish(), since
+/// marker replaces them if the output does not fit.
+template <class Sink>
+class TruncatingSink final {
+ public:
+  constexpr TruncatingSink(Sink& sink, std::size_t max_size,
+                           std::string_view marker) noexcept
+      : m_sink{sink},
+        m_max_size{max_size},
+        m_marker{marker.substr(0, max_size)},
+        m_direct_size{SaturatingSub(max_size - rng::size(m_marker),
+                                    kMaxContinuationBytes)} {}
+
+  constexpr auto operator()(std::string_view piece) -> void {
+    if (m_done) {
+      return;
+    }
+    if (m_written < m_direct_size) {
+      auto const direct{piece.substr(0, m_direct_size - m_written)};
+      m_sink(direct);
+      m_written += rng::size(direct);
+      piece.remove_prefix(rng::size(direct));
+    }
+
+    // one byte beyond the limit is enough to know the output does not fit
+    m_held += piece.substr(0, m_max_size - m_written - rng::size(m_held) + 1);
+    if (m_written + rng::size(m_held) > m_max_size) {
+      // does not split a UTF-8 sequence
+      auto cut{m_max_size - rng::size(m_marker) - m_written};
+      while (cut > 0 and
+             (static_cast<unsigned char>(m_held[cut]) & 0xc0) == 0x80) {
+        --cut;
+      }
+      m_sink(std::string_view{m_held}.substr(0, cut));
+      m_sink(m_marker);
+      m_done = true;
+    }
+  }
+
+  /// forwards the held back bytes of output that fits
+  constexpr auto Finish() -> void {
+    if (not m_done) {
+      m_sink(m_held);
+      m_held.clear();
+    }
+  }
+
+  [[nodiscard]] constexpr auto Done() const noexcept -> bool { return m_done; }
+
+ private:
+  static constexpr std::size_t kMaxContinuationBytes{3};
+
+  [[nodiscard]] static constexpr auto SaturatingSub(std::size_t lhs,
+                                                    std::size_t rhs) noexcept
+      -> std::size_t {
+    return lhs < rhs ? 0 : lhs - rhs;
+  }
+
+  Sink& m_sink;
+  std::size_t m_max_size;
+  std::string_view m_marker;
+  /// output up to here is forwarded right away: cutting it for marker never
+  /// reaches back that far
+  std::size_t m_direct_size;
+  std::size_t m_written{0};
+  std::string m_held{};
+  bool m_done{false};
+};
+
+/// format spec of Json, shared by fmt::formatter and std::formatter:
+///  - `{}` same as Dump(), e.g. `{"a": [1, 2]}`
+///  - `{:c}` compact, without any spaces: `{"a":[1,2]}`
+///  - `{:p}` / `{:p4}` pretty, indented by 2 / 4 spaces per level
+///  - `.N` suffix, e.g. `{:.200}` or `{:c.200}`, caps output at N bytes like
+///    DumpTruncated(): a cut output ends with `...` within the N bytes, and
+///    serialization stops at the cap
+struct FormatSpec {
+  WriteStyle style{};
+  std::optional<std::size_t> max_size{};
+
+  /// @return position of the closing '}', std::nullopt for an invalid spec
+  template <class Iterator>
+  constexpr auto Parse(Iterator begin, Iterator end)
+      -> std::optional<Iterator> {
+    auto const parse_number{[&begin, end]() -> std::optional<std::size_t> {
+      if (begin == end or *begin < '0' or *begin > '9') {
+        return std::nullopt;
+      }
+      std::size_t value{0};
+      for (; begin != end and *begin >= '0' and *begin <= '9'; ++begin) {
+        value = value * 10 + static_cast<std::size_t>(*begin - '0');
+      }
+      return value;
+    }};
+
+    if (begin != end and *begin == 'c') {
+      ++begin;
+      style = WriteStyle{.item_separator = ",", .key_separator = ":"};
+    } else if (begin != end and *begin == 'p') {
+      ++begin;
+      style = WriteStyle{.item_separator = ",",
+                         .key_separator = ": ",
+                         .indent = parse_number().value_or(2)};
+    }
+    if (begin != end and *begin == '.') {
+      ++begin;
+      max_size = parse_number();
+      if (not max_size) {
+        return std::nullopt;
+      }
+    }
+    if (begin != end and *begin != '}') {
+      return std::nullopt;
+    }
+    return begin;
+  }
+
+  template <class Sink>
+  constexpr auto Write(Json const& json, Sink& sink) const -> void {
+    if (max_size) {
+      TruncatingSink truncating_sink{sink, *max_size, "..."};
+      JsonWriter::Write(json, truncating_sink, style);
+      truncating_sink.Finish();
+    } else {
+      JsonWriter::Write(json, sink, style);
+    }
+  }
+};
+
+}  // namespace uzleo::json
+
+/// formats Json straight into the output of fmt::format()/fmt::print(), see
+/// uzleo::json::FormatSpec for the supported format specs
+template <>
+struct fmt::formatter<uzleo::json::Json> {
+  constexpr auto parse(fmt::format_parse_context& ctx)
+      -> fmt::format_parse_context::iterator {
+    auto const spec_end{m_spec.Parse(ctx.begin(), ctx.end())};
+    if (not spec_end) {
+      throw fmt::format_error{"invalid format spec for Json"};
+    }
+    return *spec_end;
+  }
+
+  auto format(uzleo::json::Json const& json, fmt::format_context& ctx) const
+      -> fmt::format_context::iterator {
+    auto out{ctx.out()};
+    auto sink{[&out](std::string_view piece) {
+      out = std::copy(rng::cbegin(piece), rng::cend(piece), out);
+    }};
+    m_spec.Write(json, sink);
+    return out;
+  }
+
+ private:
+  uzleo::json::FormatSpec m_spec{};
+};
+
+/// same as fmt::formatter<Json>, for std::format()/std::print()
+template <>
+struct std::formatter<uzleo::json::Json> {
+  constexpr auto parse(std::format_parse_context& ctx)
+      -> std::format_parse_context::iterator {
+    auto const spec_end{m_spec.Parse(ctx.begin(), ctx.end())};
+    if (not spec_end) {
+      throw std::format_error{"invalid format spec for Json"};
+    }
+    return *spec_end;
+  }
+
+  template <class FormatContext>
+  auto format(uzleo::json::Json const& json, FormatContext& ctx) const
+      -> decltype(ctx.out()) {
+    auto out{ctx.out()};
+    auto sink{[&out](std::string_view piece) {
+      out = std::copy(rng::cbegin(piece), rng::cend(piece), out);
+    }};
+    m_spec.Write(json, sink);
+    return out;
+  }
+
+ private:
+  uzleo::json::FormatSpec m_spec{};
+};
+
+namespace uzleo::json {
+
+constexpr auto Json::Dump() const -> std::string {
+  return fmt::format("{}", *this);
+}
+
+/// Dump() for logging: serialization stops once max_bytes are reached, so
+/// only the nodes that make it into the output are visited and the cost is
+/// bounded by max_bytes rather than by the size of the document.
+/// @return Dump() if it fits into max_bytes, otherwise a prefix of it followed
+/// by marker, max_bytes in total
+export [[nodiscard]] constexpr auto DumpTruncated(
+    Json const& json, std::size_t max_bytes, std::string_view marker = "...")
+    -> std::string {
+  static constexpr std::size_t kMaxReserve{std::size_t{64} << 10};
+
+  std::string result{};
+  result.reserve(std::min(max_bytes, kMaxReserve));
+  auto append{[&result](std::string_view piece) { result += piece; }};
+  TruncatingSink sink{append, max_bytes, marker};
+  JsonWriter::Write(json, sink);
+  sink.Finish();
+  return result;
+}
+
+/// this allocates the string buffer (holding json) data on heap so that it is
+/// alive throughout the program. This allows views over it to be used for
+/// lex/parse algorithms
+constexpr auto ReadFile(std::filesystem::path&& absolute_file_path)
+    -> std::shared_ptr<std::string const> {
+  if (not std::filesystem::exists(absolute_file_path)) {
+    throw std::invalid_argument{
+        fmt::format("Json {} file does not exist.", absolute_file_path)};
+  }
+  std::ifstream file_stream{absolute_file_path};
+  if (not file_stream.is_open()) {
+    throw std::runtime_error{
+        fmt::format("Failed to open json {} file.", absolute_file_path)};
+  }
+
+  return std::make_shared<std::string const>(
+      rng::istream_view<char>{file_stream} | rng::to<std::string>());
+}
+
+/// implementation tier of the lexing/number parsing kernels. All tiers produce
+/// identical results. By default the best tier supported by the host cpu is
+/// selected once at runtime, so a single binary runs on all x86-64 hosts.
+/// The environment variable UZLEO_JSON_KERNEL_TIER (scalar, swar, sse4.2,
+/// avx2, avx512) or SetKernelTier() force a tier for testing and benchmarking.
+export enum class KernelTier {
+  /// one byte at a time
+  kScalar,
+  /// 8 bytes at a time in 64-bit registers (SIMD within a register)
+  kSwar,
+  /// 16 bytes at a time with SSE4.2 string instructions (x86-64 only)
+  kSse42,
+  /// 32 bytes at a time (x86-64 only)
+  kAvx2,
+  /// 64 bytes at a time with AVX-512BW (x86-64 only)
+  kAvx512,
+};
+
+[[nodiscard]] constexpr auto IsJsonWhitespace(char value) noexcept -> bool {
+  return value == ' ' or value == '\n' or value == '\r' or value == '\t';
+}
+
+namespace kernels {
+
+namespace scalar {
+
+[[nodiscard]] auto SkipWhitespace(std::string_view content) noexcept
+    -> std::size_t {
+  return static_cast<std::size_t>(rng::distance(
+      rng::cbegin(content), rng::find_if_not(content, IsJsonWhitespace)));
+}
+
+[[nodiscard]] auto FindQuoteOrBackslash(std::string_view content) noexcept
+    -> std::size_t {
+  return static_cast<std::size_t>(
+      rng::distance(rng::cbegin(content), rng::find_if(content, [](char c) {
+                      return c == '"' or c == '\\';
+                    })));
+}
+
+/// scalar tier leaves all numbers to std::from_chars
+[[nodiscard]] auto ParseInteger(
+    [[maybe_unused]] std::string_view lexeme) noexcept
+    -> std::optional<double> {
+  return std::nullopt;
+}
+
+constexpr std::string_view kBase64Alphabet{
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+
+/// 6-bit value of each base64 character, 0xff for all other characters
+constexpr auto kBase64Values{[] {
+  std::array<std::uint8_t, 256> values{};
+  values.fill(0xff);
+  for (std::uint8_t value{0}; value < rng::size(kBase64Alphabet); ++value) {
+    values[static_cast<unsigned char>(kBase64Alphabet[value])] = value;
+  }
+  return values;
+}()};
+
+[[nodiscard]] auto Base64Decode(std::string_view input,
+                                std::span<std::byte> output) noexcept -> bool {
+  auto const value_of{[](char c) noexcept {
+    return std::uint32_t{kBase64Values[static_cast<unsigned char>(c)]};
+  }};
+
+  std::size_t in{0};
+  std::size_t out{0};
+  for (; in + 4 <= rng::size(input); in += 4, out += 3) {
+    auto const a{value_of(input[in])};
+    auto const b{value_of(input[in + 1])};
+    auto const c{value_of(input[in + 2])};
+    auto const d{value_of(input[in + 3])};
+    if ((a | b | c | d) > 63) {
+      return false;
+    }
+    auto const quad{a << 18 | b << 12 | c << 6 | d};
+    output[out] = static_cast<std::byte>(quad >> 16);
+    output[out + 1] = static_cast<std::byte>(quad >> 8);
+    output[out + 2] = static_cast<std::byte>(quad);
+  }
+
+  // unpadded tail of 2 or 3 characters holds 1 or 2 bytes
+  std::uint32_t bits{0};
+  for (auto const c : input.substr(in)) {
+    if (value_of(c) > 63) {
+      return false;
+    }
+    bits = bits << 6 | value_of(c);
+  }
+  switch (rng::size(input) - in) {
+    case 2: {
+      output[out] = static_cast<std::byte>(bits >> 4);
+      break;
+    }
+    case 3: {
+      output[out] = static_cast<std::byte>(bits >> 10);
+      output[out + 1] = static_cast<std::byte>(bits >> 2);
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+  return true;
+}
+
+auto Base64Encode(std::span<std::byte const> input,
+                  std::span<char> output) noexcept -> void {
+  auto const char_of{[](std::uint32_t triple, int shift) noexcept {
+    return kBase64Alphabet[(triple >> shift) & 0x3f];
+  }};
+
+  std::size_t in{0};
+  std::size_t out{0};
+  for (; in + 3 <= rng::size(input); in += 3, out += 4) {
+    auto const triple{std::to_integer<std::uint32_t>(input[in]) << 16 |
+                      std::to_integer<std::uint32_t>(input[in + 1]) << 8 |
+                      std::to_integer<std::uint32_t>(input[in + 2])};
+    output[out] = char_of(triple, 18);
+    output[out + 1] = char_of(triple, 12);
+    output[out + 2] = char_of(triple, 6);
+    output[out + 3] = char_of(triple, 0);
+  }
+
+  if (auto const remaining{rng::size(input) - in}; remaining != 0) {
+    auto const triple{
+        std::to_integer<std::uint32_t>(input[in]) << 16 |
+        (remaining == 2 ? std::to_integer<std::uint32_t>(input[in + 1]) << 8
+                        : 0)};
+    output[out] = char_of(triple, 18);
+    output[out + 1] = char_of(triple, 12);
+    output[out + 2] = remaining == 2 ? char_of(triple, 6) : '=';
+    output[out + 3] = '=';
+  }
+}
+
+}  // namespace scalar
+
+namespace swar {
+
+constexpr std::uint64_t kLsbs{0x0101010101010101};
+constexpr std::uint64_t kMsbs{0x8080808080808080};
+constexpr std::uint64_t kLow7Bits{0x7f7f7f7f7f7f7f7f};
+
+[[nodiscard]] auto Load(char const* data) noexcept -> std::uint64_t {
+  std::uint64_t word;
+  std::memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+/// @return word with the high bit set in exactly those bytes equal to value
+[[nodiscard]] constexpr auto MatchByte(std::uint64_t word, char value) noexcept
+    -> std::uint64_t {
+  auto const diff{word ^ (kLsbs * static_cast<std::uint8_t>(value))};
+  // adding 0x7f to the low 7 bits of a byte sets its high bit iff any of them
+  // is set, without carrying into the next byte
+  return ~(((diff & kLow7Bits) + kLow7Bits) | diff | kLow7Bits);
+}
+
+/// @return index of first byte (in memory order) flagged in mask
+[[nodiscard]] constexpr auto FirstByte(std::uint64_t mask) noexcept
+    -> std::size_t {
+  if constexpr (std::endian::native == std::endian::little) {
+    return static_cast<std::size_t>(std::countr_zero(mask)) / 8;
+  } else {
+    return static_cast<std::size_t>(std::countl_zero(mask)) / 8;
+  }
+}
+
+/// @return true if all 8 bytes are ascii digits
+[[nodiscard]] constexpr auto AllDigits(std::uint64_t word) noexcept -> bool {
+  return ((word & 0xf0f0f0f0f0f0f0f0) |
+          (((word + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) ==
+         0x3333333333333333;
+}
+
+/// converts 8 ascii digits (first digit in the lowest byte) into their value
+/// with 3 multiplications instead of 8
+[[nodiscard]] constexpr auto ParseEightDigits(std::uint64_t word) noexcept
+    -> std::uint64_t {
+  word = ((word & 0x0f0f0f0f0f0f0f0f) * 2561) >> 8;
+  word = ((word & 0x00ff00ff00ff00ff) * 6553601) >> 16;
+  return ((word & 0x0000ffff0000ffff) * 42949672960001) >> 32;
+}
+
+/// skips a newline followed by indentation spaces, 8 spaces at a time.
+/// Pretty-printed input mostly has whitespace of this form.
+[[nodiscard]] auto SkipIndentation(std::string_view content) noexcept
+    -> std::size_t {
+  static constexpr std::uint64_t kEightSpaces{0x2020202020202020};
+
+  std::size_t offset{0};
+  if (not rng::empty(content) and content.front() == '\n') {
+    offset = 1;
+    while (offset + 8 <= rng::size(content) and
+           Load(rng::data(content) + offset) == kEightSpaces) {
+      offset += 8;
+    }
+  }
+  return offset;
+}
+
+[[nodiscard]] auto SkipWhitespace(std::string_view content) noexcept
+    -> std::size_t {
+  auto offset{SkipIndentation(content)};
+  for (; offset + 8 <= rng::size(content); offset += 8) {
+    auto const word{Load(rng::data(content) + offset)};
+    if (auto const non_whitespace{
+            ~(MatchByte(word, ' ') | MatchByte(word, '\n') |
+              MatchByte(word, '\r') | MatchByte(word, '\t')) &
+            kMsbs};
+        non_whitespace != 0) {
+      return offset + FirstByte(non_whitespace);
+    }
+  }
+  return offset + scalar::SkipWhitespace(content.substr(offset));
+}
+
+[[nodiscard]] auto FindQuoteOrBackslash(std::string_view content) noexcept
+    -> std::size_t {
+  std::size_t offset{0};
+  for (; offset + 8 <= rng::size(content); offset += 8) {
+    auto const word{Load(rng::data(content) + offset)};
+    if (auto const match{MatchByte(word, '"') | MatchByte(word, '\\')};
+        match != 0) {
+      return offset + FirstByte(match);
+    }
+  }
+  return offset + scalar::FindQuoteOrBackslash(content.substr(offset));
+}
+
+/// fast path for integral number lexemes ([-]digits, at most 15 digits so
+/// that the value is exactly representable). Longer or fractional numbers
+/// are left to std::from_chars.
+/// @return parsed value, std::nullopt if lexeme is not handled here
+[[nodiscard]] auto ParseInteger(std::string_view lexeme) noexcept
+    -> std::optional<double> {
+  static constexpr std::size_t kMaxDigits{15};
+
+  bool const negative{not rng::empty(lexeme) and lexeme.front() == '-'};
+  auto digits{negative ? lexeme.substr(1) : lexeme};
+  if (rng::empty(digits) or rng::size(digits) > kMaxDigits) {
+    return std::nullopt;
+  }
+
+  std::uint64_t value{0};
+  for (; rng::size(digits) >= 8; digits.remove_prefix(8)) {
+    auto word{Load(rng::data(digits))};
+    if constexpr (std::endian::native == std::endian::big) {
+      word = std::byteswap(word);
+    }
+    if (not AllDigits(word)) {
+      return std::nullopt;
+    }
+    value = value * 100'000'000 + ParseEightDigits(word);
+  }
+  for (auto const c : digits) {
+    if (c < '0' or c > '9') {
+      return std::nullopt;
+    }
+    value = value * 10 + static_cast<std::uint64_t>(c - '0');
+  }
+
+  auto const result{static_cast<double>(value)};
+  return negative ? -result : result;
+}
+
+}  // namespace swar
+
+#if defined(__x86_64__)
+
+// the following kernels are compiled for their instruction set via target
+// attributes and must only be called once the cpu is known to support it
+
+namespace sse42 {
+
+/// compares each of 16 bytes against a set of bytes (SSE4.2 string
+/// instructions). The kernels pass explicit lengths (cmpestri), so NUL bytes
+/// in content are compared like all others.
+constexpr int kEqualAny{_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY};
+
+[[nodiscard, gnu::target("sse4.2")]] auto SkipWhitespace(
+    std::string_view content) noexcept -> std::size_t {
+  auto const* const data{rng::data(content)};
+  auto const whitespace{_mm_setr_epi8(' ', '\n', '\r', '\t', 0, 0, 0, 0, 0, 0,
+                                      0, 0, 0, 0, 0, 0)};
+  auto offset{swar::SkipIndentation(content)};
+  for (; offset + 16 <= rng::size(content); offset += 16) {
+    auto const chunk{
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + offset))};
+    // index of the first byte not in the set, 16 if there is none
+    if (auto const index{_mm_cmpestri(whitespace, 4, chunk, 16,
+                                      kEqualAny | _SIDD_NEGATIVE_POLARITY)};
+        index != 16) {
+      return offset + static_cast<std::size_t>(index);
+    }
+  }
+  return offset + scalar::SkipWhitespace(content.substr(offset));
+}
+
+[[nodiscard, gnu::target("sse4.2")]] auto FindQuoteOrBackslash(
+    std::string_view content) noexcept -> std::size_t {
+  auto const* const data{rng::data(content)};
+  auto const specials{
+      _mm_setr_epi8('"', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)};
+  std::size_t offset{0};
+  for (; offset + 16 <= rng::size(content); offset += 16) {
+    auto const chunk{
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + offset))};
+    if (auto const index{_mm_cmpestri(specials, 2, chunk, 16, kEqualAny)};
+        index != 16) {
+      return offset + static_cast<std::size_t>(index);
+    }
+  }
+  return offset + scalar::FindQuoteOrBackslash(content.substr(offset));
+}
+
+/// translates 16 base64 characters to their 6-bit values (Muła/Lemire
+/// nibble lookups)
+/// @return false if chunk holds a non-base64 character
+[[nodiscard, gnu::target("sse4.2")]] auto Base64Translate(
+    __m128i& chunk) noexcept -> bool {
+  auto const lut_lo{_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                  0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b,
+                                  0x1b, 0x1a)};
+  auto const lut_hi{_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04,
+                                  0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                  0x10, 0x10)};
+  auto const lut_roll{
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0)};
+  auto const mask_2f{_mm_set1_epi8(0x2f)};
+
+  auto const hi_nibbles{_mm_and_si128(_mm_srli_epi32(chunk, 4), mask_2f)};
+  auto const lo_nibbles{_mm_and_si128(chunk, mask_2f)};
+  auto const lo{_mm_shuffle_epi8(lut_lo, lo_nibbles)};
+  auto const hi{_mm_shuffle_epi8(lut_hi, hi_nibbles)};
+  if (not _mm_testz_si128(lo, hi)) {
+    return false;
+  }
+  // '/' shares its high nibble with '+' but needs its own offset
+  auto const roll{_mm_shuffle_epi8(
+      lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(chunk, mask_2f), hi_nibbles))};
+  chunk = _mm_add_epi8(chunk, roll);
+  return true;
+}
+
+/// packs 4 6-bit values per 32-bit lane into 3 bytes, in the lane's low 12
+/// bytes
+[[nodiscard, gnu::target("sse4.2")]] auto Base64Pack(__m128i values) noexcept
+    -> __m128i {
+  auto const pairs{_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140))};
+  auto const triples{_mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000))};
+  return _mm_shuffle_epi8(triples, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                 14, 13, 12, -1, -1, -1, -1));
+}
+
+/// splits the 3 bytes of each 32-bit lane, spread as bytes 1, 0, 2, 1, into
+/// 4 6-bit values and maps those to base64 characters
+[[nodiscard, gnu::target("sse4.2")]] auto Base64Characters(
+    __m128i spread) noexcept -> __m128i {
+  auto const indices{_mm_or_si128(
+      _mm_mulhi_epu16(_mm_and_si128(spread, _mm_set1_epi32(0x0fc0fc00)),
+                      _mm_set1_epi32(0x04000040)),
+      _mm_mullo_epi16(_mm_and_si128(spread, _mm_set1_epi32(0x003f03f0)),
+                      _mm_set1_epi32(0x01000010)))};
+
+  // 0..25 -> 13, 26..51 -> 0, 52..63 -> 1..12 select the offset to add
+  auto const ranges{_mm_or_si128(
+      _mm_subs_epu8(indices, _mm_set1_epi8(51)),
+      _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices),
+                    _mm_set1_epi8(13)))};
+  auto const offsets{_mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                   '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                   '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                   '/' - 63, 'A', 0, 0)};
+  return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, ranges));
+}
+
+[[nodiscard, gnu::target("sse4.2")]] auto Base64Decode(
+    std::string_view input, std::span<std::byte> output) noexcept -> bool {
+  std::size_t in{0};
+  std::size_t out{0};
+  for (; in + 16 <= rng::size(input) and out + 16 <= rng::size(output);
+       in += 16, out += 12) {
+    auto chunk{_mm_loadu_si128(
+        reinterpret_cast<__m128i const*>(rng::data(input) + in))};
+    if (not Base64Translate(chunk)) {
+      return false;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rng::data(output) + out),
+                     Base64Pack(chunk));
+  }
+  return scalar::Base64Decode(input.substr(in), output.subspan(out));
+}
+
+[[gnu::target("sse4.2")]] auto Base64Encode(
+    std::span<std::byte const> input, std::span<char> output) noexcept
+    -> void {
+  std::size_t in{0};
+  std::size_t out{0};
+  for (; in + 16 <= rng::size(input) and out + 16 <= rng::size(output);
+       in += 12, out += 16) {
+    auto const chunk{_mm_loadu_si128(
+        reinterpret_cast<__m128i const*>(rng::data(input) + in))};
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rng::data(output) + out),
+                     Base64Characters(_mm_shuffle_epi8(
+                         chunk, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8,
+                                              7, 10, 9, 11, 10))));
+  }
+  scalar::Base64Encode(input.subspan(in), output.subspan(out));
+}
+
+}  // namespace sse42
+
+namespace avx2 {
+
+[[nodiscard, gnu::target("avx2")]] auto SkipWhitespace(
+    std::string_view content) noexcept -> std::size_t {
+  auto const* const data{rng::data(content)};
+  auto offset{swar::SkipIndentation(content)};
+  for (; offset + 32 <= rng::size(content); offset += 32) {
+    auto const chunk{_mm256_loadu_si256(
+        reinterpret_cast<__m256i const*>(data + offset))};
+    auto const whitespace{_mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')),
+                        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))))};
+    if (auto const non_whitespace{
+            ~static_cast<std::uint32_t>(_mm256_movemask_epi8(whitespace))};
+        non_whitespace != 0) {
+      return offset +
+             static_cast<std::size_t>(std::countr_zero(non_whitespace));
+    }
+  }
+  return offset + sse42::SkipWhitespace(content.substr(offset));
+}
+
+[[nodiscard, gnu::target("avx2")]] auto FindQuoteOrBackslash(
+    std::string_view content) noexcept -> std::size_t {
+  auto const* const data{rng::data(content)};
+  std::size_t offset{0};
+  for (; offset + 32 <= rng::size(content); offset += 32) {
+    auto const chunk{_mm256_loadu_si256(
+        reinterpret_cast<__m256i const*>(data + offset))};
+    if (auto const match{static_cast<std::uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')),
+                            _mm256_cmpeq_epi8(chunk,
+                                              _mm256_set1_epi8('\\')))))};
+        match != 0) {
+      return offset + static_cast<std::size_t>(std::countr_zero(match));
+    }
+  }
+  return offset + sse42::FindQuoteOrBackslash(content.substr(offset));
+}
+
+[[nodiscard, gnu::target("avx2")]] auto Base64Decode(
+    std::string_view input, std::span<std::byte> output) noexcept -> bool {
+  auto const lut_lo{_mm256_broadcastsi128_si256(
+      _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a))};
+  auto const lut_hi{_mm256_broadcastsi128_si256(
+      _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10))};
+  auto const lut_roll{_mm256_broadcastsi128_si256(_mm_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0))};
+  auto const mask_2f{_mm256_set1_epi8(0x2f)};
+  auto const pack_lanes{_mm256_broadcastsi128_si256(_mm_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1))};
+
+  std::size_t in{0};
+  std::size_t out{0};
+  for (; in + 32 <= rng::size(input) and out + 32 <= rng::size(output);
+       in += 32, out += 24) {
+    auto const chunk{_mm256_loadu_si256(
+        reinterpret_cast<__m256i const*>(rng::data(input) + in))};
+    auto const hi_nibbles{
+        _mm256_and_si256(_mm256_srli_epi32(chunk, 4), mask_2f)};
+    auto const lo{
+        _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(chunk, mask_2f))};
+    auto const hi{_mm256_shuffle_epi8(lut_hi, hi_nibbles)};
+    if (not _mm256_testz_si256(lo, hi)) {
+      return false;
+    }
+    auto const values{_mm256_add_epi8(
+        chunk, _mm256_shuffle_epi8(
+                   lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(chunk, mask_2f),
+                                             hi_nibbles)))};
+
+    auto const pairs{
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140))};
+    auto const triples{
+        _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000))};
+    // 12 bytes per lane, then the two lanes joined into 24 bytes
+    auto const packed{_mm256_permutevar8x32_epi32(
+        _mm256_shuffle_epi8(triples, pack_lanes),
+        _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7))};
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rng::data(output) + out),
+                        packed);
+  }
+  return sse42::Base64Decode(input.substr(in), output.subspan(out));
+}
+
+[[gnu::target("avx2")]] auto Base64Encode(std::span<std::byte const> input,
+                                          std::span<char> output) noexcept
+    -> void {
+  auto const spread{_mm256_broadcastsi128_si256(
+      _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10))};
+
+  std::size_t in{0};
+  std::size_t out{0};
+  for (; in + 28 <= rng::size(input) and out + 32 <= rng::size(output);
+       in += 24, out += 32) {
+    // 12 input bytes per lane
+    auto const* const data{rng::data(input) + in};
+    auto const chunk{_mm256_loadu2_m128i(
+        reinterpret_cast<__m128i const*>(data + 12),
+        reinterpret_cast<__m128i const*>(data))};
+    auto const bytes{_mm256_shuffle_epi8(chunk, spread)};
+
+    auto const indices{_mm256_or_si256(
+        _mm256_mulhi_epu16(
+            _mm256_and_si256(bytes, _mm256_set1_epi32(0x0fc0fc00)),
+            _mm256_set1_epi32(0x04000040)),
+        _mm256_mullo_epi16(
+            _mm256_and_si256(bytes, _mm256_set1_epi32(0x003f03f0)),
+            _mm256_set1_epi32(0x01000010)))};
+    auto const ranges{_mm256_or_si256(
+        _mm256_subs_epu8(indices, _mm256_set1_epi8(51)),
+        _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices),
+                         _mm256_set1_epi8(13)))};
+    auto const offsets{_mm256_broadcastsi128_si256(_mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0,
+        0))};
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(rng::data(output) + out),
+        _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, ranges)));
+  }
+  sse42::Base64Encode(input.subspan(in), output.subspan(out));
+}
+
+}  // namespace avx2
+
+namespace avx512 {
+
+[[nodiscard, gnu::target("avx512f,avx512bw")]] auto SkipWhitespace(
+    std::string_view content) noexcept -> std::size_t {
+  auto const* const data{rng::data(content)};
+  auto offset{swar::SkipIndentation(content)};
+  for (; offset + 64 <= rng::size(content); offset += 64) {
+    auto const chunk{_mm512_loadu_si512(data + offset)};
+    auto const whitespace{
+        _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(' ')) |
+        _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('\n')) |
+        _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('\r')) |
+        _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('\t'))};
+    if (auto const non_whitespace{~static_cast<std::uint64_t>(whitespace)};
+        non_whitespace != 0) {
+      return offset +
+             static_cast<std::size_t>(std::countr_zero(non_whitespace));
+    }
+  }
+  return offset + sse42::SkipWhitespace(content.substr(offset));
+}
+
+[[nodiscard, gnu::target("avx512f,avx512bw")]] auto FindQuoteOrBackslash(
+    std::string_view content) noexcept -> std::size_t {
+  auto const* const data{rng::data(content)};
+  std::size_t offset{0};
+  for (; offset + 64 <= rng::size(content); offset += 64) {
+    auto const chunk{_mm512_loadu_si512(data + offset)};
+    if (auto const match{static_cast<std::uint64_t>(
+            _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('"')) |
+            _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('\\')))};
+        match != 0) {
+      return offset + static_cast<std::size_t>(std::countr_zero(match));
+    }
+  }
+  return offset + sse42::FindQuoteOrBackslash(content.substr(offset));
+}
+
+}  // namespace avx512
+
+#endif
+
+/// one implementation per kernel, all of the same tier
+struct KernelTable {
+  KernelTier tier;
+  /// @return number of leading json whitespace characters of content
+  std::size_t (*skip_whitespace)(std::string_view) noexcept;
+  /// @return offset of first '"' or '\\' in content, size of content if
+  /// there is none
+  std::size_t (*find_quote_or_backslash)(std::string_view) noexcept;
+  /// @return value of an integral number lexeme, std::nullopt if the lexeme
+  /// must be converted with std::from_chars
+  std::optional<double> (*parse_integer)(std::string_view) noexcept;
+  /// decodes unpadded base64 into exactly as many bytes as it holds
+  /// @return false if input holds a non-base64 character
+  bool (*base64_decode)(std::string_view, std::span<std::byte>) noexcept;
+  /// encodes into exactly Base64EncodedSize() characters, with padding
+  void (*base64_encode)(std::span<std::byte const>, std::span<char>) noexcept;
+};
+
+constexpr KernelTable kScalarKernels{
+    KernelTier::kScalar,  scalar::SkipWhitespace, scalar::FindQuoteOrBackslash,
+    scalar::ParseInteger, scalar::Base64Decode,   scalar::Base64Encode};
+constexpr KernelTable kSwarKernels{
+    KernelTier::kSwar,  swar::SkipWhitespace, swar::FindQuoteOrBackslash,
+    swar::ParseInteger, scalar::Base64Decode, scalar::Base64Encode};
+#if defined(__x86_64__)
+constexpr KernelTable kSse42Kernels{
+    KernelTier::kSse42, sse42::SkipWhitespace, sse42::FindQuoteOrBackslash,
+    swar::ParseInteger, sse42::Base64Decode,   sse42::Base64Encode};
+constexpr KernelTable kAvx2Kernels{
+    KernelTier::kAvx2,  avx2::SkipWhitespace, avx2::FindQuoteOrBackslash,
+    swar::ParseInteger, avx2::Base64Decode,   avx2::Base64Encode};
+// base64 has no AVX-512BW kernel; the AVX2 one is used instead
+constexpr KernelTable kAvx512Kernels{
+    KernelTier::kAvx512, avx512::SkipWhitespace, avx512::FindQuoteOrBackslash,
+    swar::ParseInteger,  avx2::Base64Decode,     avx2::Base64Encode};
+#endif
+
+[[nodiscard]] auto TableOf(KernelTier tier) noexcept -> KernelTable const& {
+  switch (tier) {
+#if defined(__x86_64__)
+    case KernelTier::kAvx512: {
+      return kAvx512Kernels;
+    }
+    case KernelTier::kAvx2: {
+      return kAvx2Kernels;
+    }
+    case KernelTier::kSse42: {
+      return kSse42Kernels;
+    }
+#endif
+    case KernelTier::kScalar: {
+      return kScalarKernels;
+    }
+    default: {
+      return kSwarKernels;
+    }
+  }
+}
+
+/// null until the first kernel call or SetKernelTier()
+constinit std::atomic<KernelTable const*> g_active_table{nullptr};
+
+}  // namespace kernels
+
+/// @return best kernel tier supported by this host (queried via cpuid)
+export [[nodiscard]] auto DetectKernelTier() noexcept -> KernelTier {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") and
+      __builtin_cpu_supports("avx512bw")) {
+    return KernelTier::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return KernelTier::kAvx2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return KernelTier::kSse42;
+  }
+#endif
+  return KernelTier::kSwar;
+}
+
+/// @return true if kernels of given tier can run on this host
+export [[nodiscard]] auto IsKernelTierSupported(KernelTier tier) noexcept
+    -> bool {
+  return std::to_underlying(tier) <= std::to_underlying(DetectKernelTier());
+}
+
+/// selects the kernels used by all subsequent lexing/parsing
+/// @throws std::invalid_argument if tier is not supported on this host
+export auto SetKernelTier(KernelTier tier) -> void {
+  if (not IsKernelTierSupported(tier)) {
+    throw std::invalid_argument{"kernel tier is not supported on this host."};
+  }
+  kernels::g_active_table.store(&kernels::TableOf(tier),
+                                std::memory_order_release);
+}
+
+namespace kernels {
+
+/// tier requested via UZLEO_JSON_KERNEL_TIER environment variable. Unknown or
+/// unsupported values are ignored.
+[[nodiscard]] auto EnvironmentKernelTier() noexcept
+    -> std::optional<KernelTier> {
+  static constexpr std::array<std::pair<std::string_view, KernelTier>, 5>
+      kTierNames{{{"scalar", KernelTier::kScalar},
+                  {"swar", KernelTier::kSwar},
+                  {"sse4.2", KernelTier::kSse42},
+                  {"avx2", KernelTier::kAvx2},
+                  {"avx512", KernelTier::kAvx512}}};
+
+  auto const* const value{std::getenv("UZLEO_JSON_KERNEL_TIER")};
+  if (value == nullptr) {
+    return std::nullopt;
+  }
+  auto const citer{rng::find(kTierNames, std::string_view{value},
+                             &std::pair<std::string_view, KernelTier>::first)};
+  if (citer == rng::cend(kTierNames) or
+      not IsKernelTierSupported(citer->second)) {
+    return std::nullopt;
+  }
+  return citer->second;
+}
+
+[[nodiscard]] auto ActiveTable() noexcept -> KernelTable const& {
+  if (auto const* table{g_active_table.load(std::memory_order_acquire)};
+      table != nullptr) {
+    return *table;
+  }
+
+  // racing first calls all store the same table
+  auto const* table{
+      &TableOf(EnvironmentKernelTier().value_or(DetectKernelTier()))};
+  g_active_table.store(table, std::memory_order_release);
+  return *table;
+}
+
+}  // namespace kernels
+
+export [[nodiscard]] auto GetKernelTier() noexcept -> KernelTier {
+  return kernels::ActiveTable().tier;
+}
+
+/// @return number of leading json whitespace characters of content
+[[nodiscard]] auto SkipWhitespace(std::string_view content) noexcept
+    -> std::size_t {
+  return kernels::ActiveTable().skip_whitespace(content);
+}
+
+/// @return offset of first '"' or '\\' in content, size of content if there
+/// is none
+[[nodiscard]] auto FindQuoteOrBackslash(std::string_view content) noexcept
+    -> std::size_t {
+  return kernels::ActiveTable().find_quote_or_backslash(content);
+}
+
+/// decodes unpadded base64 into exactly as many bytes as it holds
+/// @return false if input holds a non-base64 character
+[[nodiscard]] auto Base64Decode(std::string_view input,
+                                std::span<std::byte> output) noexcept -> bool {
+  return kernels::ActiveTable().base64_decode(input, output);
+}
+
+auto Base64Encode(std::span<std::byte const> input,
+                  std::span<char> output) noexcept -> void {
+  kernels::ActiveTable().base64_encode(input, output);
+}
+
+/// appends the unescaped form of a json string body (without the quotation
+/// marks) to out. \\uXXXX escapes, including surrogate pairs, become UTF-8.
+/// @throws std::invalid_argument for invalid escape sequences
+constexpr auto UnescapeInto(std::string_view escaped, std::string& out)
+    -> void {
+  static constexpr auto parse_hex4{[](std::string_view digits) {
+    std::uint32_t code_unit{0};
+    auto const* const end{rng::data(digits) + std::min(rng::size(digits), 4uz)};
+    if (rng::size(digits) < 4 or
+        std::from_chars(rng::data(digits), end, code_unit, 16).ptr != end) {
+      throw std::invalid_argument{"Invalid \\u escape in json string."};
+    }
+    return code_unit;
+  }};
+
+  while (not rng::empty(escaped)) {
+    // copies runs without escapes at once
+    auto const run_size{std::min(escaped.find('\\'), rng::size(escaped))};
+    out.append(escaped.substr(0, run_size));
+    escaped.remove_prefix(run_size);
+    if (rng::size(escaped) < 2) {
+      if (not rng::empty(escaped)) {
+        throw std::invalid_argument{"Incomplete escape in json string."};
+      }
+      break;
+    }
+
+    auto const escape{escaped[1]};
+    escaped.remove_prefix(2);
+    switch (escape) {
+      case '"':
+      case '\\':
+      case '/': {
+        out += escape;
+        break;
+      }
+      case 'b': {
+        out += '\b';
+        break;
+      }
+      case 'f': {
+        out += '\f';
+        break;
+      }
+      case 'n': {
+        out += '\n';
+        break;
+      }
+      case 'r': {
+        out += '\r';
+        break;
+      }
+      case 't': {
+        out += '\t';
+        break;
+      }
+      case 'u': {
+        auto code_point{parse_hex4(escaped)};
+        escaped.remove_prefix(4);
+        if (code_point >= 0xd800 and code_point < 0xdc00) {
+          if (not escaped.starts_with("\\u")) {
+            throw std::invalid_argument{"Unpaired surrogate in json string."};
+          }
+          auto const low{parse_hex4(escaped.substr(2))};
+          if (low < 0xdc00 or low >= 0xe000) {
+            throw std::invalid_argument{"Unpaired surrogate in json string."};
+          }
+          escaped.remove_prefix(6);
+          code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+        }
+
+        if (code_point < 0x80) {
+          out += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+          out += static_cast<char>(0xc0 | (code_point >> 6));
+          out += static_cast<char>(0x80 | (code_point & 0x3f));
+        } else if (code_point < 0x10000) {
+          out += static_cast<char>(0xe0 | (code_point >> 12));
+          out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+          out += static_cast<char>(0x80 | (code_point & 0x3f));
+        } else {
+          out += static_cast<char>(0xf0 | (code_point >> 18));
+          out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+          out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+          out += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+        break;
+      }
+      default: {
+        throw std::invalid_argument{
+            fmt::format("Invalid escape in json string: \\{}", escape)};
+      }
+    }
+  }
+}
+
+constexpr auto Json::GetBytes(std::vector<std::byte>& buffer) const
+    -> std::span<std::byte const> {
+  if (IsType<json_blob_t>()) {
+    return std::get<json_blob_t>(m_value);
+  }
+  if (not IsType<std::string>()) {
+    throw std::invalid_argument{"does not contain string or blob value."};
+  }
+
+  std::string_view encoded{std::get<json_string_t>(m_value).value};
+  // base64 only needs escaping for '/', which some encoders write as "\/"
+  thread_local std::string unescaped{};
+  if (encoded.contains('\\')) {
+    unescaped.clear();
+    UnescapeInto(encoded, unescaped);
+    encoded = unescaped;
+  }
+  for (auto padding{0}; padding < 2 and encoded.ends_with('='); ++padding) {
+    encoded.remove_suffix(1);
+  }
+
+  auto const tail_size{rng::size(encoded) % 4};
+  if (tail_size == 1) {
+    throw std::invalid_argument{"string value is not valid base64."};
+  }
+  buffer.resize(rng::size(encoded) / 4 * 3 +
+                (tail_size == 0 ? 0 : tail_size - 1));
+  if (not Base64Decode(encoded, buffer)) {
+    throw std::invalid_argument{"string value is not valid base64."};
+  }
+  return buffer;
+}
+
+/// @return value of an integral number lexeme, std::nullopt if the lexeme
+/// must be converted with std::from_chars
+[[nodiscard]] auto ParseInteger(std::string_view lexeme) noexcept
+    -> std::optional<double> {
+  return kernels::ActiveTable().parse_integer(lexeme);
+}
+
+/// appends the tokens of json_content to token_stream, tokens view into
+/// json_content
+constexpr auto LexInto(std::string_view json_content,
+                       TokenStream& token_stream) -> void {
+  static constexpr auto in_number{[](char value) noexcept {
+    return (std::isdigit(value) or value == '-' or value == '.' or
+            value == 'e');
+  }};
+
+  auto const json_content_end_iter{rng::cend(json_content)};
+
+  auto citer{rng::cbegin(json_content)};
+  while (citer != json_content_end_iter) {
+    switch (std::string_view tmp_view{citer, json_content_end_iter}; *citer) {
+      case '{': {
+        token_stream.emplace_back(TokenType::kLeftBrace, tmp_view.substr(0, 1));
+
+        rng::advance(citer, 1, json_content_end_iter);
+        break;
+      }
+      case '}': {
+        token_stream.emplace_back(TokenType::kRightBrace,
+                                  tmp_view.substr(0, 1));
+
+        rng::advance(citer, 1, json_content_end_iter);
+        break;
+      }
+      case 'f': {
+        if (tmp_view.starts_with("false")) {
+          token_stream.emplace_back(TokenType::kFalse, tmp_view.substr(0, 5));
 
           rng::advance(citer, 5, json_content_end_iter);
           break;
         }
 
-        throw std::invalid_argument{"Failed to lex false."};
+        throw std::invalid_argument{"Failed to lex false."};
+      }
+      case 't': {
+        if (tmp_view.starts_with("true")) {
+          token_stream.emplace_back(TokenType::kTrue, tmp_view.substr(0, 4));
+
+          rng::advance(citer, 4, json_content_end_iter);
+          break;
+        }
+
+        throw std::invalid_argument{"Failed to lex true."};
+      }
+      case 'n': {
+        if (tmp_view.starts_with("null")) {
+          token_stream.emplace_back(TokenType::kNull, tmp_view.substr(0, 4));
+
+          rng::advance(citer, 4, json_content_end_iter);
+          break;
+        }
+
+        throw std::invalid_argument{"Failed to lex null."};
+      }
+      case '"': {
+        // jump from one quote/backslash to the next, skipping the character
+        // after each backslash, until the closing quote
+        std::size_t closing_quote_offset{1};
+        while (closing_quote_offset < rng::size(tmp_view)) {
+          closing_quote_offset +=
+              FindQuoteOrBackslash(tmp_view.substr(closing_quote_offset));
+          if (closing_quote_offset >= rng::size(tmp_view) or
+              tmp_view[closing_quote_offset] == '"') {
+            break;
+          }
+          closing_quote_offset += 2;
+        }
+
+        if (closing_quote_offset < rng::size(tmp_view)) {
+          // this is pointing to string that include the quotation marks
+          // e.g. for a json string "foo", the lexeme_with_commas_size is
+          // 3(foo)+2("") = 5
+          auto const lexeme_with_commas_size{closing_quote_offset + 1};
+          token_stream.emplace_back(
+              TokenType::kString,
+              tmp_view.substr(1, lexeme_with_commas_size - 2));
+
+          rng::advance(citer, lexeme_with_commas_size, json_content_end_iter);
+          break;
+        }
+
+        throw std::invalid_argument{"Failed to lex string."};
+      }
+      case ':': {
+        token_stream.emplace_back(TokenType::kColon, tmp_view.substr(0, 1));
+
+        rng::advance(citer, 1, json_content_end_iter);
+        break;
+      }
+      case ',': {
+        token_stream.emplace_back(TokenType::kComma, tmp_view.substr(0, 1));
+
+        rng::advance(citer, 1, json_content_end_iter);
+        break;
+      }
+      case '[': {
+        token_stream.emplace_back(TokenType::kLeftBracket,
+                                  tmp_view.substr(0, 1));
+
+        rng::advance(citer, 1, json_content_end_iter);
+        break;
+      }
+      case ']': {
+        token_stream.emplace_back(TokenType::kRightBracket,
+                                  tmp_view.substr(0, 1));
+
+        rng::advance(citer, 1, json_content_end_iter);
+        break;
+      }
+      case ' ':
+      case '\n':
+      case '\r':
+      case '\t': {
+        rng::advance(citer, SkipWhitespace(tmp_view), json_content_end_iter);
+        break;
+      }
+      default: {
+        if (in_number(*citer)) {
+          auto number_end_iter{rng::find_if_not(tmp_view, in_number)};
+          auto const lexeme_size{
+              rng::distance(rng::begin(tmp_view), number_end_iter)};
+          token_stream.emplace_back(TokenType::kNumber,
+                                    tmp_view.substr(0, lexeme_size));
+
+          rng::advance(citer, lexeme_size, json_content_end_iter);
+          break;
+        }
+
+        if (std::isspace(*citer)) {
+          rng::advance(citer, 1, json_content_end_iter);
+          break;
+        }
+
+        throw std::invalid_argument{
+            fmt::format("Failed to lex character: {}", *citer)};
+      }
+    }
+  }
+}
+
+constexpr auto Lex(std::shared_ptr<std::string const>&& json_content_ptr)
+    -> std::tuple<std::shared_ptr<std::string const>, TokenStream> {
+  TokenStream token_stream{};
+  token_stream.reserve(100);
+  LexInto(*json_content_ptr, token_stream);
+
+  return std::make_tuple(std::move(json_content_ptr), std::move(token_stream));
+}
+
+export struct ParseOptions {
+  /// emit members of each object sorted by key (see ObjectMap::SortedFrom()).
+  /// Lookups become binary searches, Dump() output is deterministic and
+  /// Diff()/Merge()/operator== work as linear merges. Meant for read-mostly
+  /// documents.
+  bool sorted_keys{false};
+};
+
+/// @throws std::runtime_error if lexeme is not a valid number
+constexpr auto ParseNumber(std::string_view lexeme) -> double {
+  if (auto const integer{ParseInteger(lexeme)}) {
+    return *integer;
+  }
+
+  double value;
+  auto char_conv_result{
+      std::from_chars(rng::begin(lexeme), rng::end(lexeme), value)};
+  if (char_conv_result.ec != std::errc{} or
+      char_conv_result.ptr != rng::end(lexeme)) {
+    throw std::runtime_error(fmt::format(
+        "Failed to convert into number the token lexeme: {}", lexeme));
+  }
+  return value;
+}
+
+/// value callback of ParseTokenPrefix() that does nothing
+struct IgnoreParsedValue {
+  constexpr auto operator()(std::span<Token const> /*value_tokens*/,
+                            std::size_t /*child_count*/) const noexcept
+      -> void {}
+};
+
+/// throws if the tokens of a value end before its closing bracket
+/// @throws std::invalid_argument
+constexpr auto ExpectMoreTokens(std::span<Token const> token_stream_span)
+    -> void {
+  if (rng::empty(token_stream_span)) {
+    throw std::invalid_argument{"Unexpected end of json content."};
+  }
+}
+
+/// parses the json value at the begin of given tokens. After each value of
+/// the result, a container after its members/elements, on_value is called
+/// with the tokens of the value and its number of members/elements. Later
+/// duplicate keys are skipped without calling it, unless options.sorted_keys
+/// is set.
+/// @return the value and the tokens after it
+template <class OnValue = IgnoreParsedValue>
+constexpr auto ParseTokenPrefix(std::span<Token const> tokens,
+                                ParseOptions const& options,
+                                OnValue&& on_value = {})
+    -> std::pair<Json, std::span<Token const>> {
+  auto const parse{[&options, &on_value](this auto const& self,
+                      std::span<Token const> token_stream_span)
+                       -> std::pair<Json, std::span<Token const>> {
+    using enum TokenType;
+
+    if (rng::size(token_stream_span) == 0) {
+      throw std::invalid_argument(
+          "Recursive parse called with empty token-stream.");
+    }
+
+    auto const value_tokens{token_stream_span};
+    std::size_t child_count{0};
+    Json ret_json{std::monostate{}};
+    // switch is responsible for creating the json instance that will be
+    // returned as .first
+    switch (token_stream_span.front().type) {
+      case kLeftBrace: {
+        token_stream_span = token_stream_span.subspan(1);
+
+        Json::json_object_t inner_json{};
+        // with sorted_keys, members are collected unindexed and sorted once
+        std::vector<Json::json_object_t::value_type> sorted_entries{};
+        while (true) {
+          ExpectMoreTokens(token_stream_span);
+          if (token_stream_span.front().type == kRightBrace) {
+            child_count = options.sorted_keys ? rng::size(sorted_entries)
+                                              : rng::size(inner_json);
+            ret_json = options.sorted_keys
+                           ? Json{Json::json_object_t::SortedFrom(
+                                 std::move(sorted_entries))}
+                           : Json{std::move(inner_json)};
+            break;
+          }
+
+          if (rng::size(token_stream_span) >= 2 and
+              token_stream_span[0].type == kString and
+              token_stream_span[1].type == kColon) {
+            auto const key{token_stream_span.front().lexeme};
+            token_stream_span = token_stream_span.subspan(2);
+
+            if constexpr (not std::is_same_v<std::remove_cvref_t<OnValue>,
+                                             IgnoreParsedValue>) {
+              // the first of duplicate keys wins, so later values are not
+              // reported
+              if (not options.sorted_keys and
+                  inner_json.IndexOf(key) != Json::json_object_t::kNpos) {
+                token_stream_span =
+                    ParseTokenPrefix(token_stream_span, options).second;
+                continue;
+              }
+            }
+
+            auto parse_result_value = self(token_stream_span);
+            if (options.sorted_keys) {
+              sorted_entries.emplace_back(key,
+                                          std::move(parse_result_value.first));
+            } else {
+              inner_json.try_emplace(key, std::move(parse_result_value.first));
+            }
+            token_stream_span = parse_result_value.second;
+          } else {
+            throw std::runtime_error{fmt::format(
+                "Parser expectes string and colon for map key, token-stream: "
+                "{}",
+                token_stream_span)};
+          }
+        }
+
+        break;
+      }
+
+      case kLeftBracket: {
+        token_stream_span = token_stream_span.subspan(1);
+
+        Json::json_array_t inner_json{};
+        // TODO: reserve size ?
+        while (true) {
+          ExpectMoreTokens(token_stream_span);
+          if (token_stream_span.front().type == kRightBracket) {
+            child_count = rng::size(inner_json);
+            ret_json = Json{std::move(inner_json)};
+            break;
+          }
+
+          auto [inner_json_element, advanced_subspan] = self(token_stream_span);
+          inner_json.push_back(std::move(inner_json_element));
+          token_stream_span = advanced_subspan;
+        }
+
+        break;
+      }
+
+      case kString: {
+        ret_json = Json{std::string{token_stream_span.front().lexeme}};
+        break;
+      }
+
+      case kTrue: {
+        ret_json = Json{true};
+        break;
+      }
+
+      case kFalse: {
+        ret_json = Json{false};
+        break;
+      }
+
+      case kNull: {
+        ret_json = Json{std::monostate{}};
+        break;
+      }
+
+      case kNumber: {
+        ret_json = Json{ParseNumber(token_stream_span.front().lexeme)};
+        break;
+      }
+
+      default: {
+        throw std::logic_error{fmt::format("Unexpected token received: {}",
+                                           token_stream_span.front())};
+      }
+    }
+
+    on_value(value_tokens.first(rng::size(value_tokens) -
+                                rng::size(token_stream_span) + 1),
+             child_count);
+    token_stream_span = token_stream_span.subspan(1);
+    if (rng::size(token_stream_span) == 0) {
+      return {std::move(ret_json), token_stream_span};
+    }
+
+    auto const token_type{token_stream_span.front().type};
+    if (not(token_type == kComma or token_type == kColon or
+            token_type == kRightBrace or token_type == kRightBracket)) {
+      throw std::runtime_error(fmt::format(
+          "Parser expecting `,:}}]`, but token-stream: {}", token_stream_span));
+    }
+
+    if (token_type == kComma) {
+      token_stream_span = token_stream_span.subspan(1);
+
+      ExpectMoreTokens(token_stream_span);
+      if (token_stream_span.front().type == kRightBrace or
+          token_stream_span.front().type == kRightBracket) {
+        throw std::runtime_error(
+            fmt::format("Parser not expecting }}], but token-stream: {}",
+                        token_stream_span));
+      }
+    }
+
+    return {std::move(ret_json), token_stream_span};
+  }};
+
+  return parse(tokens);
+}
+
+/// parses the first json value of given tokens
+constexpr auto ParseTokenSpan(std::span<Token const> tokens,
+                              ParseOptions const& options) -> Json {
+  return ParseTokenPrefix(tokens, options).first;
+}
+
+constexpr auto Json::GetEmbeddedJson() const -> Json const& {
+  if (not IsType<std::string>()) {
+    throw std::invalid_argument{"does not contain string value."};
+  }
+
+  auto const& json_string{std::get<json_string_t>(m_value)};
+  auto* embedded{json_string.embedded.load(std::memory_order_acquire)};
+  if (embedded != nullptr) {
+    return *embedded;
+  }
+
+  // parsed values own their strings, so the unescaped text is only needed
+  // while lexing/parsing and its buffer can be reused across calls
+  thread_local std::string unescaped{};
+  thread_local TokenStream tokens{};
+  unescaped.clear();
+  tokens.clear();
+  UnescapeInto(json_string.value, unescaped);
+  LexInto(unescaped, tokens);
+  if (rng::empty(tokens)) {
+    throw std::invalid_argument{"string value does not contain json."};
+  }
+  auto parsed{std::make_unique<Json>(ParseTokenSpan(tokens, {}))};
+  // on a lost race, embedded is the subtree of the winning thread
+  if (json_string.embedded.compare_exchange_strong(
+          embedded, parsed.get(), std::memory_order_acq_rel,
+          std::memory_order_acquire)) {
+    return *parsed.release();
+  }
+  return *embedded;
+}
+
+constexpr auto ParseTokens(std::tuple<std::shared_ptr<std::string const>,
+                                      TokenStream>&& token_stream_with_buffer,
+                           ParseOptions const& options) -> Json {
+  return ParseTokenSpan(std::get<TokenStream>(token_stream_with_buffer),
+                        options);
+}
+
+export [[nodiscard]] constexpr auto Parse(
+    std::filesystem::path&& absolute_file_path,
+    ParseOptions const& options = {}) -> Json {
+  return std::optional{ReadFile(std::move(absolute_file_path))}
+      .transform(Lex)
+      .transform([&options](auto&& token_stream_with_buffer) {
+        return ParseTokens(std::move(token_stream_with_buffer), options);
+      })
+      .value();
+}
+
+export [[nodiscard]] constexpr auto Parse(std::string_view json_content,
+                                          ParseOptions const& options = {})
+    -> Json {
+  // parsed values own their strings, so the tokens can view json_content
+  // directly instead of a shared copy of it
+  TokenStream token_stream{};
+  token_stream.reserve(100);
+  LexInto(json_content, token_stream);
+  return ParseTokenSpan(token_stream, options);
+}
+
+export struct DiffEntry {
+  enum class Kind { kAdded, kRemoved, kChanged };
+
+  Kind kind{Kind::kChanged};
+  /// json pointer (RFC 6901) to the differing value
+  std::string path{};
+};
+
+/// lists differences that turn lhs into rhs. Objects in sorted layout are
+/// compared with a linear merge of their members.
+export [[nodiscard]] constexpr auto Diff(Json const& lhs, Json const& rhs)
+    -> std::vector<DiffEntry> {
+  using enum DiffEntry::Kind;
+
+  std::vector<DiffEntry> diff{};
+  std::string path{};
+
+  auto const with_segment{[&path](std::string_view segment, auto&& fn) {
+    auto const path_size{rng::size(path)};
+    path += '/';
+    for (auto const c : segment) {
+      if (c == '~') {
+        path += "~0";
+      } else if (c == '/') {
+        path += "~1";
+      } else {
+        path += c;
+      }
+    }
+    fn();
+    path.resize(path_size);
+  }};
+
+  auto const diff_json{[&](this auto const& self, Json const& lhs_json,
+                           Json const& rhs_json) -> void {
+    if (lhs_json.IsType<Json::json_object_t>() and
+        rhs_json.IsType<Json::json_object_t>()) {
+      auto const& lhs_map{lhs_json.GetMap()};
+      auto const& rhs_map{rhs_json.GetMap()};
+
+      if (lhs_map.IsSorted() and rhs_map.IsSorted()) {
+        auto lhs_citer{rng::cbegin(lhs_map)};
+        auto rhs_citer{rng::cbegin(rhs_map)};
+        while (lhs_citer != rng::cend(lhs_map) or
+               rhs_citer != rng::cend(rhs_map)) {
+          if (rhs_citer == rng::cend(rhs_map) or
+              (lhs_citer != rng::cend(lhs_map) and
+               lhs_citer->first < rhs_citer->first)) {
+            with_segment(lhs_citer->first,
+                         [&] { diff.emplace_back(kRemoved, path); });
+            ++lhs_citer;
+          } else if (lhs_citer == rng::cend(lhs_map) or
+                     rhs_citer->first < lhs_citer->first) {
+            with_segment(rhs_citer->first,
+                         [&] { diff.emplace_back(kAdded, path); });
+            ++rhs_citer;
+          } else {
+            with_segment(lhs_citer->first, [&] {
+              self(lhs_citer->second, rhs_citer->second);
+            });
+            ++lhs_citer;
+            ++rhs_citer;
+          }
+        }
+        return;
+      }
+
+      for (auto const& [key, value] : lhs_map) {
+        with_segment(key, [&] {
+          if (auto const citer{rhs_map.find(key)};
+              citer != rng::cend(rhs_map)) {
+            self(value, citer->second);
+          } else {
+            diff.emplace_back(kRemoved, path);
+          }
+        });
+      }
+      for (auto const& [key, value] : rhs_map) {
+        if (not lhs_map.contains(key)) {
+          with_segment(key, [&] { diff.emplace_back(kAdded, path); });
+        }
+      }
+      return;
+    }
+
+    if (lhs_json.IsType<Json::json_array_t>() and
+        rhs_json.IsType<Json::json_array_t>()) {
+      auto const lhs_array{lhs_json.GetArray()};
+      auto const rhs_array{rhs_json.GetArray()};
+      for (std::size_t index{0};
+           index < std::max(rng::size(lhs_array), rng::size(rhs_array));
+           ++index) {
+        with_segment(fmt::format("{}", index), [&] {
+          if (index >= rng::size(rhs_array)) {
+            diff.emplace_back(kRemoved, path);
+          } else if (index >= rng::size(lhs_array)) {
+            diff.emplace_back(kAdded, path);
+          } else {
+            self(lhs_array[index], rhs_array[index]);
+          }
+        });
+      }
+      return;
+    }
+
+    if (not(lhs_json == rhs_json)) {
+      diff.emplace_back(kChanged, path);
+    }
+  }};
+
+  diff_json(lhs, rhs);
+  return diff;
+}
+
+/// layers overlay on top of base: members of objects are merged recursively,
+/// any other overlay value replaces the base value. Two objects in sorted
+/// layout are merged with a single linear pass.
+export [[nodiscard]] constexpr auto Merge(Json&& base, Json&& overlay)
+    -> Json {
+  using json_object_t = Json::json_object_t;
+
+  if (not base.IsType<json_object_t>() or
+      not overlay.IsType<json_object_t>()) {
+    return std::move(overlay);
+  }
+
+  auto base_map{std::move(base).GetMap()};
+  auto overlay_map{std::move(overlay).GetMap()};
+
+  if (base_map.IsSorted() and overlay_map.IsSorted()) {
+    auto base_entries{std::move(base_map).ExtractEntries()};
+    auto overlay_entries{std::move(overlay_map).ExtractEntries()};
+
+    std::vector<json_object_t::value_type> merged_entries{};
+    merged_entries.reserve(rng::size(base_entries) +
+                           rng::size(overlay_entries));
+    auto base_iter{rng::begin(base_entries)};
+    auto overlay_iter{rng::begin(overlay_entries)};
+    while (base_iter != rng::end(base_entries) or
+           overlay_iter != rng::end(overlay_entries)) {
+      if (overlay_iter == rng::end(overlay_entries) or
+          (base_iter != rng::end(base_entries) and
+           base_iter->first < overlay_iter->first)) {
+        merged_entries.push_back(std::move(*base_iter++));
+      } else if (base_iter == rng::end(base_entries) or
+                 overlay_iter->first < base_iter->first) {
+        merged_entries.push_back(std::move(*overlay_iter++));
+      } else {
+        merged_entries.emplace_back(
+            std::move(base_iter->first),
+            Merge(std::move(base_iter->second),
+                  std::move(overlay_iter->second)));
+        ++base_iter;
+        ++overlay_iter;
+      }
+    }
+
+    return Json{json_object_t::SortedFrom(std::move(merged_entries))};
+  }
+
+  for (auto&& [key, value] : std::move(overlay_map).ExtractEntries()) {
+    if (base_map.contains(key)) {
+      auto& base_value{base_map.at(key)};
+      base_value = Merge(std::move(base_value), std::move(value));
+    } else {
+      base_map.try_emplace(key, std::move(value));
+    }
+  }
+
+  return Json{std::move(base_map)};
+}
+
+/// splits a json pointer (RFC 6901) into its segments, with `~1` and `~0`
+/// unescaped to `/` and `~`
+class JsonPointerSegments final {
+ public:
+  /// @throws std::invalid_argument for an invalid json pointer
+  constexpr explicit JsonPointerSegments(std::string_view json_pointer)
+      : m_rest{json_pointer} {
+    if (not rng::empty(json_pointer) and json_pointer.front() != '/') {
+      throw std::invalid_argument{
+          fmt::format("Invalid json pointer: {}", json_pointer)};
+    }
+  }
+
+  /// @return the next segment, valid until the next call; std::nullopt
+  /// after the last one
+  [[nodiscard]] constexpr auto Next() -> std::optional<std::string_view> {
+    if (rng::empty(m_rest)) {
+      return std::nullopt;
+    }
+    m_rest.remove_prefix(1);
+    auto const raw_segment{m_rest.substr(0, m_rest.find('/'))};
+    m_rest.remove_prefix(rng::size(raw_segment));
+
+    m_segment.clear();
+    for (std::size_t index{0}; index < rng::size(raw_segment); ++index) {
+      if (auto const next{index + 1 < rng::size(raw_segment)
+                              ? raw_segment[index + 1]
+                              : '\0'};
+          raw_segment[index] == '~' and (next == '0' or next == '1')) {
+        m_segment += next == '0' ? '~' : '/';
+        ++index;
+      } else {
+        m_segment += raw_segment[index];
+      }
+    }
+    return m_segment;
+  }
+
+ private:
+  std::string_view m_rest;
+  std::string m_segment{};
+};
+
+/// stage-1 structural index of a json document: its tokens plus, for every
+/// opening bracket/brace, the position of the matching closing one. Building
+/// an Index lexes the document once; DOM parsing of the whole document or of
+/// any subtree (see Parse(Index const&, ...)) and raw-text queries reuse it
+/// without scanning the text again. Serialize() stores the index so that
+/// repeated loads of the same document can skip lexing entirely.
+export class Index final {
+ public:
+  /// lexes the given document and builds its index
+  /// @throws std::invalid_argument for content that fails to lex or has
+  /// unbalanced brackets
+  [[nodiscard]] static constexpr auto FromContent(
+      std::shared_ptr<std::string const>&& json_content_ptr) -> Index {
+    auto [buffer, tokens]{Lex(std::move(json_content_ptr))};
+    return Index{std::move(buffer), std::move(tokens)};
+  }
+
+  /// restores an index written by Serialize() for the given document
+  /// @throws std::invalid_argument if bytes are malformed or were not
+  /// serialized for this document content
+  [[nodiscard]] static constexpr auto Deserialize(
+      std::span<std::byte const> bytes,
+      std::shared_ptr<std::string const>&& json_content_ptr) -> Index {
+    auto const read{[&bytes]<class T>(std::type_identity<T>) {
+      if (rng::size(bytes) < sizeof(T)) {
+        throw std::invalid_argument{"Serialized index is truncated."};
+      }
+      T value;
+      std::memcpy(&value, rng::data(bytes), sizeof(T));
+      bytes = bytes.subspan(sizeof(T));
+      return value;
+    }};
+
+    if (read(std::type_identity<std::uint32_t>{}) != kMagic or
+        read(std::type_identity<std::uint32_t>{}) != kVersion) {
+      throw std::invalid_argument{"Serialized index has unknown format."};
+    }
+    auto const& json_content{*json_content_ptr};
+    if (read(std::type_identity<std::uint64_t>{}) != rng::size(json_content) or
+        read(std::type_identity<std::uint64_t>{}) != HashKey(json_content)) {
+      throw std::invalid_argument{
+          "Serialized index does not belong to json content."};
+    }
+
+    auto const token_count{read(std::type_identity<std::uint64_t>{})};
+    if (token_count > rng::size(bytes) / 9) {
+      throw std::invalid_argument{"Serialized index is truncated."};
+    }
+    TokenStream tokens(token_count);
+    for (auto& token : tokens) {
+      auto const type{read(std::type_identity<std::uint8_t>{})};
+      auto const offset{read(std::type_identity<std::uint32_t>{})};
+      auto const length{read(std::type_identity<std::uint32_t>{})};
+      if (type > std::to_underlying(TokenType::kNull) or
+          std::size_t{offset} + length > rng::size(json_content)) {
+        throw std::invalid_argument{"Serialized index is corrupt."};
+      }
+      // string lexemes exclude their quotation marks, which Find() relies on
+      if (type == std::to_underlying(TokenType::kString) and
+          (offset == 0 or
+           std::size_t{offset} + length == rng::size(json_content) or
+           json_content[offset - 1] != '"' or
+           json_content[std::size_t{offset} + length] != '"')) {
+        throw std::invalid_argument{"Serialized index is corrupt."};
+      }
+      token = Token{static_cast<TokenType>(type),
+                    std::string_view{json_content}.substr(offset, length)};
+    }
+
+    return Index{std::move(json_content_ptr), std::move(tokens)};
+  }
+
+  /// layout (host byte order): magic, version, content size, content hash,
+  /// token count, then type/offset/length of every token
+  /// @throws std::length_error for documents of 4 GiB or more
+  [[nodiscard]] constexpr auto Serialize() const -> std::vector<std::byte> {
+    if (rng::size(*m_buffer) > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::length_error{"Json content is too large to serialize."};
+    }
+
+    std::vector<std::byte> bytes{};
+    bytes.reserve(32 + rng::size(m_tokens) * 9);
+    auto const write{[&bytes](auto value) {
+      auto const offset{rng::size(bytes)};
+      bytes.resize(offset + sizeof(value));
+      std::memcpy(rng::data(bytes) + offset, &value, sizeof(value));
+    }};
+
+    write(kMagic);
+    write(kVersion);
+    write(std::uint64_t{rng::size(*m_buffer)});
+    write(HashKey(*m_buffer));
+    write(std::uint64_t{rng::size(m_tokens)});
+    for (auto const& token : m_tokens) {
+      write(static_cast<std::uint8_t>(std::to_underlying(token.type)));
+      write(static_cast<std::uint32_t>(rng::data(token.lexeme) -
+                                       rng::data(*m_buffer)));
+      write(static_cast<std::uint32_t>(rng::size(token.lexeme)));
+    }
+    return bytes;
+  }
+
+  [[nodiscard]] constexpr auto Content() const noexcept -> std::string_view {
+    return *m_buffer;
+  }
+
+  [[nodiscard]] constexpr auto TokenCount() const noexcept -> std::size_t {
+    return rng::size(m_tokens);
+  }
+
+  /// @return raw text of the value at given json pointer (RFC 6901, "" for
+  /// the root), std::nullopt if there is no such value
+  /// @throws std::invalid_argument for a malformed json pointer
+  [[nodiscard]] constexpr auto Find(std::string_view json_pointer) const
+      -> std::optional<std::string_view> {
+    return Locate(json_pointer).transform([this](auto const& token_range) {
+      auto const& first_token{m_tokens[token_range.first]};
+      auto const& last_token{m_tokens[token_range.second]};
+      // string lexemes exclude their quotation marks
+      auto const quote{first_token.type == TokenType::kString ? 1 : 0};
+      auto const* const begin{rng::data(first_token.lexeme) - quote};
+      auto const* const end{rng::data(last_token.lexeme) +
+                            rng::size(last_token.lexeme) + quote};
+      return std::string_view{begin, end};
+    });
+  }
+
+  [[nodiscard]] constexpr auto Contains(std::string_view json_pointer) const
+      -> bool {
+    return Locate(json_pointer).has_value();
+  }
+
+  /// builds the DOM of the value at given json pointer
+  /// @throws std::invalid_argument if there is no such value
+  [[nodiscard]] constexpr auto Parse(std::string_view json_pointer,
+                                     ParseOptions const& options) const
+      -> Json {
+    auto const token_range{Locate(json_pointer)};
+    if (not token_range) {
+      throw std::invalid_argument{
+          fmt::format("Json does not contain value at {}.", json_pointer)};
+    }
+
+    return ParseTokenSpan(
+        std::span{m_tokens}.subspan(
+            token_range->first, token_range->second - token_range->first + 1),
+        options);
+  }
+
+ private:
+  static constexpr std::uint32_t kMagic{0x494a5a55};  // "UZJI"
+  static constexpr std::uint32_t kVersion{1};
+
+  /// @throws std::invalid_argument for unbalanced brackets
+  constexpr Index(std::shared_ptr<std::string const>&& buffer,
+                  TokenStream&& tokens)
+      : m_buffer{std::move(buffer)},
+        m_tokens{std::move(tokens)},
+        m_matching(rng::size(m_tokens), 0) {
+    using enum TokenType;
+
+    if (rng::size(m_tokens) > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::length_error{"Json content has too many tokens to index."};
+    }
+
+    std::vector<std::uint32_t> open_tokens{};
+    for (std::uint32_t index{0}; index < rng::size(m_tokens); ++index) {
+      switch (auto const type{m_tokens[index].type}; type) {
+        case kLeftBrace:
+        case kLeftBracket: {
+          open_tokens.push_back(index);
+          break;
+        }
+        case kRightBrace:
+        case kRightBracket: {
+          if (rng::empty(open_tokens) or
+              m_tokens[open_tokens.back()].type !=
+                  (type == kRightBrace ? kLeftBrace : kLeftBracket)) {
+            throw std::invalid_argument{
+                "Json content has unbalanced brackets."};
+          }
+          m_matching[open_tokens.back()] = index;
+          open_tokens.pop_back();
+          break;
+        }
+        default: {
+          break;
+        }
+      }
+    }
+    if (not rng::empty(open_tokens)) {
+      throw std::invalid_argument{"Json content has unbalanced brackets."};
+    }
+  }
+
+  /// @return position of the last token of the value starting at given token
+  [[nodiscard]] constexpr auto ValueEnd(std::size_t first) const noexcept
+      -> std::size_t {
+    auto const type{m_tokens[first].type};
+    return (type == TokenType::kLeftBrace or type == TokenType::kLeftBracket)
+               ? m_matching[first]
+               : first;
+  }
+
+  /// @return first and last token of the value at given json pointer
+  [[nodiscard]] constexpr auto Locate(std::string_view json_pointer) const
+      -> std::optional<std::pair<std::size_t, std::size_t>> {
+    using enum TokenType;
+
+    JsonPointerSegments segments{json_pointer};
+    if (rng::empty(m_tokens)) {
+      return std::nullopt;
+    }
+
+    std::size_t current{0};
+    while (auto const next_segment{segments.Next()}) {
+      auto const segment{*next_segment};
+
+      // walks the members/elements of the current container, jumping over
+      // nested values with the matching-bracket index
+      auto const closing_type{
+          m_tokens[current].type == kLeftBrace ? kRightBrace : kRightBracket};
+      std::size_t element_index{0};
+      std::size_t requested_index{std::numeric_limits<std::size_t>::max()};
+      if (m_tokens[current].type == kLeftBracket) {
+        auto const conv_result{std::from_chars(
+            rng::data(segment), rng::data(segment) + rng::size(segment),
+            requested_index)};
+        if (conv_result.ec != std::errc{} or
+            conv_result.ptr != rng::data(segment) + rng::size(segment)) {
+          return std::nullopt;
+        }
+      } else if (m_tokens[current].type != kLeftBrace) {
+        return std::nullopt;
+      }
+
+      auto position{current + 1};
+      std::optional<std::size_t> found{};
+      while (position < rng::size(m_tokens) and
+             m_tokens[position].type != closing_type) {
+        auto value_position{position};
+        if (closing_type == kRightBrace) {
+          value_position += 2;
+          // BuildIndex() only checks lexing and brackets, so keys are
+          // checked here
+          if (value_position >= rng::size(m_tokens) or
+              m_tokens[position].type != kString or
+              m_tokens[position + 1].type != kColon) {
+            return std::nullopt;
+          }
+          if (m_tokens[position].lexeme == segment) {
+            found = value_position;
+            break;
+          }
+        } else if (element_index++ == requested_index) {
+          found = value_position;
+          break;
+        }
+
+        position = ValueEnd(value_position) + 1;
+        if (position < rng::size(m_tokens) and
+            m_tokens[position].type == kComma) {
+          ++position;
+        }
+      }
+      if (not found) {
+        return std::nullopt;
+      }
+      current = *found;
+    }
+
+    return std::pair{current, ValueEnd(current)};
+  }
+
+  std::shared_ptr<std::string const> m_buffer;
+  TokenStream m_tokens;
+  /// for each opening bracket/brace token, position of the matching closing
+  /// token (0 for all other tokens)
+  std::vector<std::uint32_t> m_matching;
+};
+
+/// builds a reusable structural index of the given json content
+export [[nodiscard]] constexpr auto BuildIndex(std::string_view json_content)
+    -> Index {
+  return Index::FromContent(std::make_shared<std::string const>(json_content));
+}
+
+export [[nodiscard]] constexpr auto BuildIndex(
+    std::filesystem::path&& absolute_file_path) -> Index {
+  return Index::FromContent(ReadFile(std::move(absolute_file_path)));
+}
+
+/// builds the DOM of the indexed document, or of the value at the given json
+/// pointer, without lexing the document again
+/// @throws std::invalid_argument if there is no value at json_pointer
+export [[nodiscard]] constexpr auto Parse(Index const& index,
+                                          std::string_view json_pointer = "",
+                                          ParseOptions const& options = {})
+    -> Json {
+  return index.Parse(json_pointer, options);
+}
+
+/// input range over the elements of a top-level json array stored in a file,
+/// for documents too large to hold as a single Json. The file is read in
+/// chunks and every element is lexed and parsed on its own, reusing the read
+/// and token buffers, so memory stays bounded by the largest element. The
+/// element yielded by the iterator is replaced when it advances; move it out
+/// to keep it.
+export class ArrayStream final {
+ public:
+  class Iterator final {
+   public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = Json;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr Iterator() noexcept = default;
+    constexpr explicit Iterator(ArrayStream* stream) noexcept
+        : m_stream{stream} {}
+
+    [[nodiscard]] constexpr auto operator*() const noexcept -> Json& {
+      return m_stream->m_current;
+    }
+
+    /// @throws std::invalid_argument for malformed content
+    constexpr auto operator++() -> Iterator& {
+      m_stream->Advance();
+      return *this;
+    }
+
+    constexpr auto operator++(int) -> void { ++*this; }
+
+    [[nodiscard]] constexpr auto operator==(std::default_sentinel_t) const
+        noexcept -> bool {
+      return m_stream == nullptr or m_stream->m_done;
+    }
+
+   private:
+    ArrayStream* m_stream{nullptr};
+  };
+
+  /// @throws std::invalid_argument if file does not exist
+  /// @throws std::runtime_error if file can not be opened
+  constexpr explicit ArrayStream(std::filesystem::path&& absolute_file_path,
+                                 ParseOptions const& options = {})
+      : m_options{options} {
+    if (not std::filesystem::exists(absolute_file_path)) {
+      throw std::invalid_argument{
+          fmt::format("Json {} file does not exist.", absolute_file_path)};
+    }
+    m_file.open(absolute_file_path, std::ios::binary);
+    if (not m_file.is_open()) {
+      throw std::runtime_error{
+          fmt::format("Failed to open json {} file.", absolute_file_path)};
+    }
+  }
+
+  // iterators point back into the stream
+  ArrayStream(ArrayStream const&) = delete;
+  auto operator=(ArrayStream const&) -> ArrayStream& = delete;
+
+  /// reads the first element; an ArrayStream can only be iterated once
+  /// @throws std::invalid_argument for malformed content
+  [[nodiscard]] constexpr auto begin() -> Iterator {
+    if (not m_started) {
+      Advance();
+    }
+    return Iterator{this};
+  }
+
+  [[nodiscard]] constexpr auto end() const noexcept -> std::default_sentinel_t {
+    return std::default_sentinel;
+  }
+
+ private:
+  static constexpr std::size_t kChunkSize{std::size_t{1} << 20};
+
+  /// drops the consumed prefix of m_buffer and appends the next chunk of the
+  /// file; only the element being scanned is moved
+  /// @return false at end of file
+  constexpr auto Refill() -> bool {
+    m_buffer.erase(0, m_element_begin);
+    m_position -= m_element_begin;
+    m_element_begin = 0;
+
+    auto const old_size{rng::size(m_buffer)};
+    m_buffer.resize_and_overwrite(
+        old_size + kChunkSize, [this, old_size](char* data, std::size_t) {
+          m_file.read(data + old_size, kChunkSize);
+          return old_size + static_cast<std::size_t>(m_file.gcount());
+        });
+    return rng::size(m_buffer) > old_size;
+  }
+
+  constexpr auto SkipBufferedWhitespace() -> void {
+    do {
+      m_position +=
+          SkipWhitespace(std::string_view{m_buffer}.substr(m_position));
+    } while (m_position == rng::size(m_buffer) and Refill());
+  }
+
+  constexpr auto ExpectMoreContent() -> void {
+    if (m_position == rng::size(m_buffer) and not Refill()) {
+      throw std::invalid_argument{"Json array stream ended unexpectedly."};
+    }
+  }
+
+  constexpr auto Finish() -> void {
+    m_done = true;
+    SkipBufferedWhitespace();
+    if (m_position != rng::size(m_buffer)) {
+      throw std::invalid_argument{
+          "Json array stream has content after the array."};
+    }
+  }
+
+  /// parses the next element into m_current, or marks the stream done
+  constexpr auto Advance() -> void {
+    m_element_begin = m_position;
+    SkipBufferedWhitespace();
+    ExpectMoreContent();
+    if (not m_started) {
+      m_started = true;
+      if (m_buffer[m_position++] != '[') {
+        throw std::invalid_argument{"Json array stream must start with `[`."};
+      }
+      SkipBufferedWhitespace();
+      ExpectMoreContent();
+      if (m_buffer[m_position] == ']') {
+        ++m_position;
+        Finish();
+        return;
+      }
+    } else if (m_buffer[m_position++] == ']') {
+      Finish();
+      return;
+    }
+
+    // finds the `,` or `]` that ends the element: outside of strings and
+    // nested containers
+    m_element_begin = m_position;
+    std::size_t depth{0};
+    bool in_string{false};
+    while (true) {
+      ExpectMoreContent();
+      if (in_string) {
+        m_position +=
+            FindQuoteOrBackslash(std::string_view{m_buffer}.substr(m_position));
+        if (m_position == rng::size(m_buffer)) {
+          continue;
+        }
+        if (m_buffer[m_position] == '\\') {
+          ++m_position;
+          ExpectMoreContent();
+        } else {
+          in_string = false;
+        }
+        ++m_position;
+        continue;
+      }
+
+      auto const character{m_buffer[m_position]};
+      if (character == '"') {
+        in_string = true;
+      } else if (character == '{' or character == '[') {
+        ++depth;
+      } else if (character == '}' or character == ']') {
+        if (depth == 0) {
+          if (character == '}') {
+            throw std::invalid_argument{
+                "Json array stream has unbalanced brackets."};
+          }
+          break;
+        }
+        --depth;
+      } else if (character == ',' and depth == 0) {
+        break;
+      }
+      ++m_position;
+    }
+
+    m_tokens.clear();
+    LexInto(std::string_view{m_buffer}.substr(m_element_begin,
+                                              m_position - m_element_begin),
+            m_tokens);
+    if (rng::empty(m_tokens)) {
+      throw std::invalid_argument{"Json array stream has an empty element."};
+    }
+    auto [element, rest]{ParseTokenPrefix(m_tokens, m_options)};
+    if (not rng::empty(rest)) {
+      throw std::invalid_argument{fmt::format(
+          "Json array stream has tokens after an element: {}", rest)};
+    }
+    m_current = std::move(element);
+  }
+
+  std::ifstream m_file{};
+  ParseOptions m_options;
+  /// content read so far; everything before m_element_begin is consumed
+  std::string m_buffer{};
+  std::size_t m_element_begin{0};
+  std::size_t m_position{0};
+  TokenStream m_tokens{};
+  Json m_current{std::monostate{}};
+  bool m_started{false};
+  bool m_done{false};
+};
+
+static_assert(rng::input_range<ArrayStream>);
+
+/// streams the elements of the top-level array in given file one at a time:
+/// `for (Json& record : StreamArray(path)) { ... }`
+/// @throws std::invalid_argument if file does not exist
+/// @throws std::runtime_error if file can not be opened
+export [[nodiscard]] constexpr auto StreamArray(
+    std::filesystem::path&& absolute_file_path,
+    ParseOptions const& options = {}) -> ArrayStream {
+  return ArrayStream{std::move(absolute_file_path), options};
+}
+
+export struct DumpFileOptions {
+  /// fsync the file, and its directory after the rename, so that the dump
+  /// survives a crash of the machine. Skipping it is considerably faster.
+  bool sync{true};
+  /// serialized output is collected into a buffer of this size and written
+  /// with one syscall per full buffer
+  std::size_t buffer_size{std::size_t{1} << 20};
+};
+
+/// JsonWriter sink that writes to a temporary file next to the target through
+/// a large page-aligned buffer. Commit() publishes the file under the target
+/// path with an atomic rename; a sink destroyed without Commit() removes the
+/// temporary file, so readers never observe a partially written target.
+class AtomicFileSink final {
+ public:
+  /// @throws std::runtime_error if the temporary file can not be created or
+  /// given the permissions of an existing target
+  AtomicFileSink(std::filesystem::path target_path, std::size_t buffer_size)
+      : m_target_path{std::move(target_path)},
+        m_temp_path{m_target_path},
+        m_capacity{std::max(buffer_size, kAlignment)},
+        m_buffer{static_cast<char*>(
+            ::operator new(m_capacity, std::align_val_t{kAlignment}))} {
+    m_temp_path += fmt::format(".{:x}.tmp", std::random_device{}());
+#if defined(__unix__) or defined(__APPLE__)
+    m_file = ::open(m_temp_path.c_str(),
+                    O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (m_file < 0) {
+      throw std::runtime_error{fmt::format("Failed to create {}: {}",
+                                           m_temp_path.string(),
+                                           std::strerror(errno))};
+    }
+    // an existing target keeps its permissions, e.g. 0600 of a private
+    // snapshot, instead of getting those of a new file
+    if (struct stat target_status{};
+        ::stat(m_target_path.c_str(), &target_status) == 0 and
+        ::fchmod(m_file, target_status.st_mode & 07777) != 0) {
+      auto const error{errno};
+      ::close(m_file);
+      ::unlink(m_temp_path.c_str());
+      throw std::runtime_error{
+          fmt::format("Failed to set permissions of {}: {}",
+                      m_temp_path.string(), std::strerror(error))};
+    }
+#else
+    m_file = std::fopen(m_temp_path.string().c_str(), "wbx");
+    if (m_file == nullptr) {
+      throw std::runtime_error{
+          fmt::format("Failed to create {}.", m_temp_path.string())};
+    }
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+#endif
+  }
+
+  AtomicFileSink(AtomicFileSink const&) = delete;
+  auto operator=(AtomicFileSink const&) -> AtomicFileSink& = delete;
+
+  ~AtomicFileSink() {
+    if (not m_committed) {
+      std::ignore = Close();
+      std::error_code error_code{};
+      std::filesystem::remove(m_temp_path, error_code);
+    }
+  }
+
+  /// @throws std::runtime_error if writing fails
+  auto operator()(std::string_view piece) -> void {
+    if (rng::size(piece) > m_capacity - m_size) {
+      Flush();
+      // pieces as large as the buffer gain nothing from copying
+      if (rng::size(piece) >= m_capacity) {
+        WriteAll(piece);
+        return;
+      }
+    }
+    std::memcpy(m_buffer.get() + m_size, rng::data(piece), rng::size(piece));
+    m_size += rng::size(piece);
+  }
+
+  /// writes remaining output and renames the temporary file to the target
+  /// @throws std::runtime_error if writing, syncing, closing or renaming
+  /// fails
+  auto Commit(bool sync) -> void {
+    Flush();
+#if defined(__unix__) or defined(__APPLE__)
+    if (sync and ::fsync(m_file) != 0) {
+      throw std::runtime_error{fmt::format("Failed to sync {}: {}",
+                                           m_temp_path.string(),
+                                           std::strerror(errno))};
+    }
+#endif
+    // without sync, deferred write errors (e.g. NFS, quota) are reported at
+    // close, and the file must not be published then
+    if (not Close()) {
+      throw std::runtime_error{fmt::format("Failed to close {}: {}",
+                                           m_temp_path.string(),
+                                           std::strerror(errno))};
+    }
+    std::filesystem::rename(m_temp_path, m_target_path);
+    m_committed = true;
+
+#if defined(__unix__) or defined(__APPLE__)
+    // makes the rename itself durable
+    if (sync) {
+      auto const directory_path{m_target_path.parent_path().empty()
+                                    ? std::filesystem::path{"."}
+                                    : m_target_path.parent_path()};
+      auto const directory{
+          ::open(directory_path.c_str(), O_RDONLY | O_CLOEXEC)};
+      if (directory < 0) {
+        throw std::runtime_error{fmt::format("Failed to open {}: {}",
+                                             directory_path.string(),
+                                             std::strerror(errno))};
+      }
+      auto const synced{::fsync(directory) == 0};
+      auto const error{errno};
+      ::close(directory);
+      if (not synced) {
+        throw std::runtime_error{fmt::format("Failed to sync {}: {}",
+                                             directory_path.string(),
+                                             std::strerror(error))};
+      }
+    }
+#endif
+  }
+
+ private:
+  static constexpr std::size_t kAlignment{4096};
+
+  struct AlignedDelete {
+    auto operator()(char* buffer) const noexcept -> void {
+      ::operator delete(buffer, std::align_val_t{kAlignment});
+    }
+  };
+
+  auto Flush() -> void {
+    WriteAll(std::string_view{m_buffer.get(), m_size});
+    m_size = 0;
+  }
+
+  auto WriteAll(std::string_view bytes) -> void {
+#if defined(__unix__) or defined(__APPLE__)
+    while (not rng::empty(bytes)) {
+      auto const written{::write(m_file, rng::data(bytes), rng::size(bytes))};
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error{fmt::format("Failed to write {}: {}",
+                                             m_temp_path.string(),
+                                             std::strerror(errno))};
+      }
+      bytes.remove_prefix(static_cast<std::size_t>(written));
+    }
+#else
+    if (std::fwrite(rng::data(bytes), 1, rng::size(bytes), m_file) !=
+        rng::size(bytes)) {
+      throw std::runtime_error{
+          fmt::format("Failed to write {}.", m_temp_path.string())};
+    }
+#endif
+  }
+
+  /// @return false if closing reported an error
+  auto Close() noexcept -> bool {
+    auto closed{true};
+#if defined(__unix__) or defined(__APPLE__)
+    if (m_file >= 0) {
+      closed = ::close(m_file) == 0;
+      m_file = -1;
+    }
+#else
+    if (m_file != nullptr) {
+      closed = std::fclose(m_file) == 0;
+      m_file = nullptr;
+    }
+#endif
+    return closed;
+  }
+
+  std::filesystem::path m_target_path;
+  std::filesystem::path m_temp_path;
+  std::size_t m_capacity;
+  /// page-aligned
+  std::unique_ptr<char[], AlignedDelete> m_buffer;
+  std::size_t m_size{0};
+#if defined(__unix__) or defined(__APPLE__)
+  int m_file{-1};
+#else
+  std::FILE* m_file{nullptr};
+#endif
+  bool m_committed{false};
+};
+
+/// writes json, formatted as by Dump(), to given file without building the
+/// text in memory. The file is replaced atomically: it either keeps its old
+/// content or holds the complete new dump, never a partial one.
+/// @throws std::runtime_error if the file can not be written
+export auto DumpToFile(std::filesystem::path&& absolute_file_path,
+                       Json const& json, DumpFileOptions const& options = {})
+    -> void {
+  AtomicFileSink sink{std::move(absolute_file_path), options.buffer_size};
+  JsonWriter::Write(json, sink);
+  sink.Commit(options.sync);
+}
+
+/// immutable json value of a hash-consed document (see Freeze()). Identical
+/// subtrees and strings of all documents frozen with the same FrozenPool are
+/// stored once and shared, which makes copies cheap (a reference count) and
+/// comparing shared subtrees O(1).
+export class FrozenJson final {
+ public:
+  using string_t = std::shared_ptr<std::string const>;
+  using member_t = std::pair<string_t, FrozenJson>;
+  using object_t = std::vector<member_t>;
+  using array_t = std::vector<FrozenJson>;
+
+  /// T is one of bool, double, std::monostate, std::string, object_t, array_t
+  template <class T>
+  [[nodiscard]] auto IsType() const noexcept -> bool;
+
+  /// @throws std::invalid_argument if not a string value
+  [[nodiscard]] auto GetStringView() const -> std::string_view;
+  /// @throws std::invalid_argument if not a number value
+  [[nodiscard]] auto GetDouble() const -> double;
+  /// @throws std::invalid_argument if not an array value
+  [[nodiscard]] auto GetArray() const -> std::span<FrozenJson const>;
+  /// members in document order
+  /// @throws std::invalid_argument if not an object value
+  [[nodiscard]] auto GetMembers() const -> std::span<member_t const>;
+
+  /// linear search, objects are usually small
+  /// @throws std::logic_error if not an object value
+  [[nodiscard]] auto Contains(std::string_view key) const -> bool;
+  /// @throws std::logic_error if not an object value
+  /// @throws std::invalid_argument if key does not exist
+  [[nodiscard]] auto GetJson(std::string_view key) const -> FrozenJson const&;
+
+  /// @return true if both refer to the same shared node, i.e. were frozen
+  /// with the same pool and are equal
+  [[nodiscard]] auto IsSameNode(FrozenJson const& other) const noexcept
+      -> bool {
+    return m_node == other.m_node;
+  }
+
+  /// deep, mutable copy
+  [[nodiscard]] auto ToJson() const -> Json;
+
+  [[nodiscard]] auto Dump() const -> std::string { return ToJson().Dump(); }
+
+  /// deep comparison; O(1) for nodes of the same pool. Objects are compared
+  /// irrespective of member order, like for Json.
+  [[nodiscard]] friend auto operator==(FrozenJson const& lhs,
+                                       FrozenJson const& rhs) -> bool {
+    return lhs.IsSameNode(rhs) or Equal(lhs, rhs);
+  }
+
+ private:
+  friend class FrozenPool;
+  struct Node;
+
+  explicit FrozenJson(std::shared_ptr<Node const>&& node) noexcept
+      : m_node{std::move(node)} {}
+
+  [[nodiscard]] static auto Equal(FrozenJson const& lhs, FrozenJson const& rhs)
+      -> bool;
+
+  std::shared_ptr<Node const> m_node;
+};
+
+struct FrozenJson::Node {
+  using value_t = std::variant<bool, double, std::monostate, string_t,
+                               object_t, array_t>;
+
+  value_t value;
+  /// structural hash, derived from the hashes of the children
+  std::uint64_t hash;
+};
+
+template <class T>
+auto FrozenJson::IsType() const noexcept -> bool {
+  if constexpr (std::same_as<T, std::string>) {
+    return std::holds_alternative<string_t>(m_node->value);
+  } else {
+    return std::holds_alternative<T>(m_node->value);
+  }
+}
+
+auto FrozenJson::GetStringView() const -> std::string_view {
+  if (not IsType<std::string>()) {
+    throw std::invalid_argument{"does not contain string value."};
+  }
+  return *std::get<string_t>(m_node->value);
+}
+
+auto FrozenJson::GetDouble() const -> double {
+  if (not IsType<double>()) {
+    throw std::invalid_argument{"does not contain double value."};
+  }
+  return std::get<double>(m_node->value);
+}
+
+auto FrozenJson::GetArray() const -> std::span<FrozenJson const> {
+  if (not IsType<array_t>()) {
+    throw std::invalid_argument{"does not contain array value."};
+  }
+  return std::get<array_t>(m_node->value);
+}
+
+auto FrozenJson::GetMembers() const -> std::span<member_t const> {
+  if (not IsType<object_t>()) {
+    throw std::invalid_argument{"does not contain map value."};
+  }
+  return std::get<object_t>(m_node->value);
+}
+
+auto FrozenJson::Contains(std::string_view key) const -> bool {
+  if (not IsType<object_t>()) {
+    throw std::logic_error{"json is not an object."};
+  }
+  return rng::any_of(
+      std::get<object_t>(m_node->value),
+      [key](auto const& member) { return *member.first == key; });
+}
+
+auto FrozenJson::GetJson(std::string_view key) const -> FrozenJson const& {
+  if (not IsType<object_t>()) {
+    throw std::logic_error{"json is not an object."};
+  }
+  auto const& members{std::get<object_t>(m_node->value)};
+  auto const citer{rng::find_if(
+      members, [key](auto const& member) { return *member.first == key; })};
+  if (citer == rng::cend(members)) {
+    throw std::invalid_argument{fmt::format("does not contain {} key.", key)};
+  }
+  return citer->second;
+}
+
+auto FrozenJson::ToJson() const -> Json {
+  return std::visit(
+      overloaded{
+          [](bool value) { return Json{value}; },
+          [](double value) { return Json{value}; },
+          [](std::monostate monostate) { return Json{monostate}; },
+          [](string_t const& value) { return Json{std::string_view{*value}}; },
+          [](object_t const& value) {
+            Json::json_object_t json_object{};
+            json_object.reserve(rng::size(value));
+            for (auto const& [key, member_value] : value) {
+              json_object.try_emplace(*key, member_value.ToJson());
+            }
+            return Json{std::move(json_object)};
+          },
+          [](array_t const& value) {
+            Json::json_array_t json_array{};
+            json_array.reserve(rng::size(value));
+            for (auto const& element : value) {
+              json_array.push_back(element.ToJson());
+            }
+            return Json{std::move(json_array)};
+          }},
+      m_node->value);
+}
+
+auto FrozenJson::Equal(FrozenJson const& lhs, FrozenJson const& rhs) -> bool {
+  auto const& lhs_value{lhs.m_node->value};
+  auto const& rhs_value{rhs.m_node->value};
+  if (lhs_value.index() != rhs_value.index()) {
+    return false;
+  }
+
+  return std::visit(
+      overloaded{
+          [&rhs_value](string_t const& value) {
+            return *value == *std::get<string_t>(rhs_value);
+          },
+          [&rhs_value](object_t const& value) {
+            auto const& rhs_members{std::get<object_t>(rhs_value)};
+            return rng::size(value) == rng::size(rhs_members) and
+                   rng::all_of(value, [&rhs_members](auto const& member) {
+                     auto const citer{rng::find_if(
+                         rhs_members, [&member](auto const& rhs_member) {
+                           return *rhs_member.first == *member.first;
+                         })};
+                     return citer != rng::cend(rhs_members) and
+                            citer->second == member.second;
+                   });
+          },
+          [&rhs_value](auto const& value) {
+            return value == std::get<std::remove_cvref_t<decltype(value)>>(
+                                rhs_value);
+          }},
+      lhs_value);
+}
+
+/// interning tables of hash-consed documents. Nodes and strings stay in the
+/// pool until Collect() finds them unreferenced. Not thread-safe: freeze
+/// documents sharing a pool from one thread at a time.
+export class FrozenPool final {
+ public:
+  /// @return number of distinct subtrees stored
+  [[nodiscard]] auto NodeCount() const noexcept -> std::size_t {
+    return rng::size(m_nodes);
+  }
+
+  /// @return number of distinct strings (keys and values) stored
+  [[nodiscard]] auto StringCount() const noexcept -> std::size_t {
+    return rng::size(m_strings);
+  }
+
+  /// drops nodes and strings that no FrozenJson refers to anymore
+  auto Collect() -> void {
+    // dropping a parent releases its children, hence until nothing changes
+    for (auto erased{std::size_t{1}}; erased != 0;) {
+      erased = std::erase_if(m_nodes, [](auto const& entry) {
+        return entry.second.use_count() == 1;
+      });
+    }
+    std::erase_if(m_strings, [](auto const& entry) {
+      return entry.second.use_count() == 1;
+    });
+  }
+
+ private:
+  friend class FrozenBuilder;
+
+  /// @return the pooled copy of given string
+  [[nodiscard]] auto InternString(std::string_view value)
+      -> FrozenJson::string_t {
+    if (auto const citer{m_strings.find(value)};
+        citer != rng::cend(m_strings)) {
+      return citer->second;
+    }
+    auto string{std::make_shared<std::string const>(value)};
+    m_strings.emplace(*string, string);
+    return string;
+  }
+
+  /// @return the pooled node equal to value. Children of value are pooled
+  /// already, so equality is decided by comparing their addresses.
+  [[nodiscard]] auto Intern(FrozenJson::Node::value_t&& value) -> FrozenJson {
+    auto const hash{HashOf(value)};
+    for (auto [iter, end]{m_nodes.equal_range(hash)}; iter != end; ++iter) {
+      if (ShallowEqual(iter->second->value, value)) {
+        return FrozenJson{std::shared_ptr{iter->second}};
+      }
+    }
+
+    auto node{std::make_shared<FrozenJson::Node const>(
+        FrozenJson::Node{std::move(value), hash})};
+    m_nodes.emplace(hash, node);
+    return FrozenJson{std::move(node)};
+  }
+
+  [[nodiscard]] static constexpr auto Mix(std::uint64_t seed,
+                                          std::uint64_t value) noexcept
+      -> std::uint64_t {
+    return (std::rotl(seed, 5) ^ value) * 0x9e3779b97f4a7c15;
+  }
+
+  [[nodiscard]] static auto HashOf(FrozenJson::Node::value_t const& value)
+      -> std::uint64_t {
+    return std::visit(
+        overloaded{
+            [](bool boolean) { return Mix(1, boolean ? 1 : 0); },
+            [](double number) {
+              return Mix(2, std::bit_cast<std::uint64_t>(number));
+            },
+            []([[maybe_unused]] std::monostate monostate) {
+              return Mix(3, 0);
+            },
+            [](FrozenJson::string_t const& string) {
+              return Mix(4, HashKey(*string));
+            },
+            [](FrozenJson::object_t const& members) {
+              auto hash{Mix(5, rng::size(members))};
+              for (auto const& [key, member_value] : members) {
+                hash = Mix(Mix(hash, HashKey(*key)), member_value.m_node->hash);
+              }
+              return hash;
+            },
+            [](FrozenJson::array_t const& elements) {
+              auto hash{Mix(6, rng::size(elements))};
+              for (auto const& element : elements) {
+                hash = Mix(hash, element.m_node->hash);
+              }
+              return hash;
+            }},
+        value);
+  }
+
+  [[nodiscard]] static auto ShallowEqual(
+      FrozenJson::Node::value_t const& lhs,
+      FrozenJson::Node::value_t const& rhs) -> bool {
+    if (lhs.index() != rhs.index()) {
+      return false;
+    }
+
+    return std::visit(
+        overloaded{
+            [&rhs](double number) {
+              // tells 0.0 and -0.0 apart
+              return std::bit_cast<std::uint64_t>(number) ==
+                     std::bit_cast<std::uint64_t>(std::get<double>(rhs));
+            },
+            [&rhs](FrozenJson::object_t const& members) {
+              return rng::equal(
+                  members, std::get<FrozenJson::object_t>(rhs),
+                  [](auto const& lhs_member, auto const& rhs_member) {
+                    return lhs_member.first == rhs_member.first and
+                           lhs_member.second.IsSameNode(rhs_member.second);
+                  });
+            },
+            [&rhs](FrozenJson::array_t const& elements) {
+              return rng::equal(elements, std::get<FrozenJson::array_t>(rhs),
+                                [](auto const& lhs_element,
+                                   auto const& rhs_element) {
+                                  return lhs_element.IsSameNode(rhs_element);
+                                });
+            },
+            // strings are pooled, so the pointers are compared
+            [&rhs](auto const& scalar) {
+              return scalar ==
+                     std::get<std::remove_cvref_t<decltype(scalar)>>(rhs);
+            }},
+        lhs);
+  }
+
+  std::unordered_multimap<std::uint64_t,
+                          std::shared_ptr<FrozenJson::Node const>>
+      m_nodes{};
+  /// keys view into the pooled strings
+  std::unordered_map<std::string_view, FrozenJson::string_t> m_strings{};
+};
+
+/// builds frozen nodes bottom-up straight from tokens, each node interned as
+/// soon as it is complete, so no intermediate Json DOM is built
+class FrozenBuilder final {
+ public:
+  FrozenBuilder(std::span<Token const> tokens, FrozenPool& pool) noexcept
+      : m_tokens{tokens}, m_pool{pool} {}
+
+  /// @throws std::invalid_argument/std::runtime_error for malformed json
+  [[nodiscard]] auto Build() -> FrozenJson {
+    auto value{Value()};
+    if (m_position != rng::size(m_tokens)) {
+      throw std::runtime_error{fmt::format(
+          "Unexpected tokens after json value: {}",
+          m_tokens.subspan(m_position))};
+    }
+    return value;
+  }
+
+ private:
+  [[nodiscard]] auto Next() -> Token const& {
+    if (m_position == rng::size(m_tokens)) {
+      throw std::invalid_argument{"Unexpected end of json content."};
+    }
+    return m_tokens[m_position++];
+  }
+
+  auto Expect(TokenType type) -> void {
+    if (auto const& token{Next()}; token.type != type) {
+      throw std::runtime_error{
+          fmt::format("Parser expected {}, but got: {}", Token{type}, token)};
+    }
+  }
+
+  [[nodiscard]] auto Value() -> FrozenJson {
+    using enum TokenType;
+
+    switch (auto const& token{Next()}; token.type) {
+      case kLeftBrace: {
+        FrozenJson::object_t members{};
+        if (m_position < rng::size(m_tokens) and
+            m_tokens[m_position].type == kRightBrace) {
+          ++m_position;
+          return m_pool.Intern(std::move(members));
+        }
+        while (true) {
+          auto const& key{Next()};
+          if (key.type != kString) {
+            throw std::runtime_error{
+                fmt::format("Parser expects string for map key, got: {}", key)};
+          }
+          Expect(kColon);
+          auto value{Value()};
+          members.emplace_back(m_pool.InternString(key.lexeme),
+                               std::move(value));
+          if (auto const& separator{Next()}; separator.type == kRightBrace) {
+            return m_pool.Intern(std::move(members));
+          } else if (separator.type != kComma) {
+            throw std::runtime_error{fmt::format(
+                "Parser expecting `,}}`, but got: {}", separator)};
+          }
+        }
+      }
+      case kLeftBracket: {
+        FrozenJson::array_t elements{};
+        if (m_position < rng::size(m_tokens) and
+            m_tokens[m_position].type == kRightBracket) {
+          ++m_position;
+          return m_pool.Intern(std::move(elements));
+        }
+        while (true) {
+          elements.push_back(Value());
+          if (auto const& separator{Next()}; separator.type == kRightBracket) {
+            return m_pool.Intern(std::move(elements));
+          } else if (separator.type != kComma) {
+            throw std::runtime_error{fmt::format(
+                "Parser expecting `,]`, but got: {}", separator)};
+          }
+        }
+      }
+      case kString: {
+        return m_pool.Intern(m_pool.InternString(token.lexeme));
+      }
+      case kNumber: {
+        return m_pool.Intern(ParseNumber(token.lexeme));
+      }
+      case kTrue: {
+        return m_pool.Intern(true);
+      }
+      case kFalse: {
+        return m_pool.Intern(false);
+      }
+      case kNull: {
+        return m_pool.Intern(std::monostate{});
+      }
+      default: {
+        throw std::logic_error{
+            fmt::format("Unexpected token received: {}", token)};
+      }
+    }
+  }
+
+  std::span<Token const> m_tokens;
+  std::size_t m_position{0};
+  FrozenPool& m_pool;
+};
+
+/// parses json content into a hash-consed, immutable document: while parsing,
+/// every completed subtree and every string is looked up in pool by its
+/// structural hash and shared with equal ones frozen before, e.g. the same
+/// nested metadata objects or enum strings repeated across cached documents.
+/// @throws std::invalid_argument/std::runtime_error for malformed json
+export [[nodiscard]] auto Freeze(std::string_view json_content,
+                                 FrozenPool& pool) -> FrozenJson {
+  TokenStream tokens{};
+  LexInto(json_content, tokens);
+  return FrozenBuilder{tokens, pool}.Build();
+}
+
+export [[nodiscard]] auto Freeze(std::filesystem::path&& absolute_file_path,
+                                 FrozenPool& pool) -> FrozenJson {
+  return Freeze(*ReadFile(std::move(absolute_file_path)), pool);
+}
+
+/// integral numbers that are exact as integers, i.e. up to 2^53 and not -0.0,
+/// are stored as zigzag varints by CompactJson and the delta wire format
+[[nodiscard]] constexpr auto IsVarintNumber(double value) noexcept -> bool {
+  return value == std::trunc(value) and std::abs(value) < 0x1p53 and
+         not(value == 0.0 and std::signbit(value));
+}
+
+[[nodiscard]] constexpr auto ZigZagEncode(double value) noexcept
+    -> std::uint64_t {
+  auto const integer{static_cast<std::int64_t>(value)};
+  return (static_cast<std::uint64_t>(integer) << 1) ^
+         static_cast<std::uint64_t>(integer >> 63);
+}
+
+[[nodiscard]] constexpr auto ZigZagDecode(std::uint64_t zigzag) noexcept
+    -> double {
+  return static_cast<double>(static_cast<std::int64_t>(zigzag >> 1) ^
+                             -static_cast<std::int64_t>(zigzag & 1));
+}
+
+/// minimum prefix excess and total excess (opens minus closes) of every byte
+/// of a balanced parentheses bit vector, bits read from least significant
+struct ByteExcess {
+  std::int8_t min;
+  std::int8_t total;
+};
+
+inline constexpr auto kByteExcess{[] {
+  std::array<ByteExcess, 256> table{};
+  for (std::size_t byte{0}; byte < rng::size(table); ++byte) {
+    std::int8_t excess{0};
+    std::int8_t min{8};
+    for (std::size_t bit{0}; bit < 8; ++bit) {
+      excess += ((byte >> bit) & 1) != 0 ? 1 : -1;
+      min = std::min(min, excess);
+    }
+    table[byte] = ByteExcess{min, excess};
+  }
+  return table;
+}()};
+
+/// tree structure as balanced parentheses: a set bit opens a node, a cleared
+/// bit closes it, nodes appear in preorder. Two bits per node plus a rank
+/// directory of one counter per 512 bits.
+class BalancedParentheses final {
+ public:
+  constexpr auto PushOpen() -> void { Push(true); }
+  constexpr auto PushClose() -> void { Push(false); }
+
+  /// builds the rank directory, call once after the last push
+  constexpr auto Finalize() -> void {
+    m_block_ranks.assign(1, 0);
+    for (std::size_t word{0}; word < rng::size(m_words); word += kBlockWords) {
+      auto rank{m_block_ranks.back()};
+      for (auto const bits : std::span{m_words}.subspan(
+               word, std::min(kBlockWords, rng::size(m_words) - word))) {
+        rank += static_cast<std::uint32_t>(std::popcount(bits));
+      }
+      m_block_ranks.push_back(rank);
+    }
+  }
+
+  [[nodiscard]] constexpr auto IsOpen(std::size_t position) const noexcept
+      -> bool {
+    return ((m_words[position / 64] >> (position % 64)) & 1) != 0;
+  }
+
+  /// @return number of opens before position, i.e. the preorder number of the
+  /// node opened at position
+  [[nodiscard]] constexpr auto Rank(std::size_t position) const noexcept
+      -> std::size_t {
+    auto const word{position / 64};
+    std::size_t rank{m_block_ranks[word / kBlockWords]};
+    for (auto block_word{word - word % kBlockWords}; block_word < word;
+         ++block_word) {
+      rank += static_cast<std::size_t>(std::popcount(m_words[block_word]));
+    }
+    if (auto const bit{position % 64}; bit != 0) {
+      rank += static_cast<std::size_t>(
+          std::popcount(m_words[word] & ((std::uint64_t{1} << bit) - 1)));
+    }
+    return rank;
+  }
+
+  /// @return position of the close matching the open at position. Scans a
+  /// byte at a time using kByteExcess, so it is linear in the subtree size.
+  [[nodiscard]] constexpr auto FindClose(std::size_t position) const noexcept
+      -> std::size_t {
+    std::int32_t excess{1};
+    ++position;
+    for (; position % 8 != 0; ++position) {
+      excess += IsOpen(position) ? 1 : -1;
+      if (excess == 0) {
+        return position;
+      }
+    }
+    while (true) {
+      auto const byte{(m_words[position / 64] >> (position % 64)) & 0xff};
+      if (excess + kByteExcess[byte].min > 0) {
+        excess += kByteExcess[byte].total;
+        position += 8;
+        continue;
+      }
+      for (;; ++position) {
+        excess += IsOpen(position) ? 1 : -1;
+        if (excess == 0) {
+          return position;
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] constexpr auto ByteSize() const noexcept -> std::size_t {
+    return rng::size(m_words) * sizeof(std::uint64_t) +
+           rng::size(m_block_ranks) * sizeof(std::uint32_t);
+  }
+
+ private:
+  static constexpr std::size_t kBlockWords{8};
+
+  constexpr auto Push(bool open) -> void {
+    if (m_size % 64 == 0) {
+      m_words.push_back(0);
+    }
+    m_words.back() |= std::uint64_t{open} << (m_size % 64);
+    ++m_size;
+  }
+
+  std::vector<std::uint64_t> m_words{};
+  /// opens before each block of kBlockWords words
+  std::vector<std::uint32_t> m_block_ranks{};
+  std::size_t m_size{0};
+};
+
+/// read-only, compressed form of a Json document for caches holding many
+/// documents in memory. Navigation and lookups work directly on the compressed
+/// form:
+/// - structure: balanced parentheses bits (BalancedParentheses)
+/// - node kinds: 4 bits per node
+/// - strings and keys: a sorted dictionary of distinct strings, referenced by
+///   varint ids. Object nodes list the key ids of their members.
+/// - numbers: integral values as zigzag varints, others as 8 raw bytes
+/// - payloads: one varint stream in preorder, with the offset of every 16th
+///   node sampled so that a node's payload is found after decoding at most 15
+///   others
+///
+/// ```cpp
+/// auto const compact{uzleo::json::CompactJson::FromJson(json)};
+/// auto const lat{compact.Root().GetJson("location").GetJson("lat")};
+/// ```
+export class CompactJson final {
+ public:
+  class Cursor;
+
+  /// @throws std::length_error for documents with 4 GiB or more of strings or
+  /// payload
+  [[nodiscard]] static constexpr auto FromJson(Json const& json)
+      -> CompactJson {
+    CompactJson compact{};
+    std::vector<std::string_view> strings{};
+    CollectStrings(json, strings);
+    rng::sort(strings);
+    strings.erase(rng::begin(rng::unique(strings)), rng::end(strings));
+
+    compact.m_string_offsets.reserve(rng::size(strings) + 1);
+    compact.m_string_offsets.push_back(0);
+    for (auto const string : strings) {
+      compact.m_strings += string;
+      compact.m_string_offsets.push_back(
+          static_cast<std::uint32_t>(rng::size(compact.m_strings)));
+    }
+    compact.Append(json);
+    compact.m_structure.Finalize();
+
+    if (constexpr auto kMaxSize{std::numeric_limits<std::uint32_t>::max()};
+        rng::size(compact.m_strings) > kMaxSize or
+        rng::size(compact.m_payload) > kMaxSize) {
+      throw std::length_error{"Json content is too large to compact."};
+    }
+    compact.m_strings.shrink_to_fit();
+    compact.m_payload.shrink_to_fit();
+    compact.m_kinds.shrink_to_fit();
+    compact.m_samples.shrink_to_fit();
+    return compact;
+  }
+
+  /// cursors point into this instance and are invalidated by moving it
+  [[nodiscard]] constexpr auto Root() const noexcept -> Cursor;
+
+  /// @return heap and inline bytes held by this instance
+  [[nodiscard]] constexpr auto ByteSize() const noexcept -> std::size_t {
+    return sizeof(CompactJson) + m_structure.ByteSize() + m_kinds.capacity() +
+           m_payload.capacity() +
+           m_samples.capacity() * sizeof(std::uint32_t) + m_strings.capacity() +
+           m_string_offsets.capacity() * sizeof(std::uint32_t);
+  }
+
+  [[nodiscard]] constexpr auto NodeCount() const noexcept -> std::size_t {
+    return m_node_count;
+  }
+
+ private:
+  enum class Kind : std::uint8_t {
+    kNull,
+    kFalse,
+    kTrue,
+    kInteger,
+    kDouble,
+    kString,
+    kObject,
+    kArray,
+    kBlob
+  };
+
+  static constexpr std::size_t kSampleRate{16};
+
+  static constexpr auto CollectStrings(Json const& json,
+                                       std::vector<std::string_view>& strings)
+      -> void {
+    if (json.IsType<std::string>()) {
+      strings.push_back(json.GetStringView());
+    } else if (json.IsType<Json::json_object_t>()) {
+      for (auto const& [key, value] : json.GetMap()) {
+        strings.push_back(key);
+        CollectStrings(value, strings);
+      }
+    } else if (json.IsType<Json::json_array_t>()) {
+      for (auto const& element : json.GetArray()) {
+        CollectStrings(element, strings);
+      }
+    }
+  }
+
+  constexpr auto AppendVarint(std::uint64_t value) -> void {
+    for (; value >= 0x80; value >>= 7) {
+      m_payload.push_back(static_cast<std::uint8_t>(value | 0x80));
+    }
+    m_payload.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  [[nodiscard]] constexpr auto ReadVarint(std::size_t& offset) const noexcept
+      -> std::uint64_t {
+    std::uint64_t value{0};
+    for (std::size_t shift{0};; shift += 7) {
+      auto const byte{m_payload[offset++]};
+      value |= std::uint64_t{byte & 0x7fu} << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+  }
+
+  [[nodiscard]] constexpr auto StringId(std::string_view string) const noexcept
+      -> std::optional<std::size_t> {
+    auto const ids{std::views::iota(std::size_t{0}, StringCount())};
+    auto const iter{rng::lower_bound(
+        ids, string, {}, [this](std::size_t id) { return String(id); })};
+    if (iter == rng::end(ids) or String(*iter) != string) {
+      return std::nullopt;
+    }
+    return *iter;
+  }
+
+  [[nodiscard]] constexpr auto StringCount() const noexcept -> std::size_t {
+    return rng::size(m_string_offsets) - 1;
+  }
+
+  [[nodiscard]] constexpr auto String(std::size_t id) const noexcept
+      -> std::string_view {
+    return std::string_view{m_strings}.substr(
+        m_string_offsets[id], m_string_offsets[id + 1] - m_string_offsets[id]);
+  }
+
+  constexpr auto AppendNode(Kind kind) -> void {
+    if (m_node_count % kSampleRate == 0) {
+      m_samples.push_back(static_cast<std::uint32_t>(rng::size(m_payload)));
+    }
+    if (m_node_count % 2 == 0) {
+      m_kinds.push_back(std::to_underlying(kind));
+    } else {
+      m_kinds.back() |=
+          static_cast<std::uint8_t>(std::to_underlying(kind) << 4);
+    }
+    ++m_node_count;
+    m_structure.PushOpen();
+  }
+
+  constexpr auto Append(Json const& json) -> void {
+    std::visit(
+        overloaded{
+            [this](bool value) {
+              AppendNode(value ? Kind::kTrue : Kind::kFalse);
+            },
+            [this](double value) {
+              if (IsVarintNumber(value)) {
+                AppendNode(Kind::kInteger);
+                AppendVarint(ZigZagEncode(value));
+              } else {
+                AppendNode(Kind::kDouble);
+                auto const bits{std::bit_cast<std::uint64_t>(value)};
+                for (std::size_t shift{0}; shift < 64; shift += 8) {
+                  m_payload.push_back(static_cast<std::uint8_t>(bits >> shift));
+                }
+              }
+            },
+            [this]([[maybe_unused]] std::monostate monostate) {
+              AppendNode(Kind::kNull);
+            },
+            [this](Json::json_string_t const& value) {
+              AppendNode(Kind::kString);
+              AppendVarint(*StringId(value.value));
+            },
+            [this](Json::json_object_t const& value) {
+              AppendNode(Kind::kObject);
+              AppendVarint(rng::size(value));
+              for (auto const& [key, member_value] : value) {
+                AppendVarint(*StringId(key));
+              }
+              for (auto const& [key, member_value] : value) {
+                Append(member_value);
+              }
+            },
+            [this](Json::json_array_t const& value) {
+              AppendNode(Kind::kArray);
+              AppendVarint(rng::size(value));
+              for (auto const& element : value) {
+                Append(element);
+              }
+            },
+            [this](Json::json_blob_t const& value) {
+              AppendNode(Kind::kBlob);
+              AppendVarint(rng::size(value));
+              for (auto const byte : value) {
+                m_payload.push_back(std::to_integer<std::uint8_t>(byte));
+              }
+            }},
+        json.m_value);
+    m_structure.PushClose();
+  }
+
+  [[nodiscard]] constexpr auto KindOf(std::size_t node) const noexcept
+      -> Kind {
+    return static_cast<Kind>((m_kinds[node / 2] >> (node % 2 * 4)) & 0xf);
+  }
+
+  constexpr auto SkipPayload(Kind kind, std::size_t& offset) const noexcept
+      -> void {
+    switch (kind) {
+      case Kind::kInteger:
+      case Kind::kString:
+      case Kind::kArray: {
+        std::ignore = ReadVarint(offset);
+        break;
+      }
+      case Kind::kDouble: {
+        offset += 8;
+        break;
+      }
+      case Kind::kObject: {
+        for (auto count{ReadVarint(offset)}; count != 0; --count) {
+          std::ignore = ReadVarint(offset);
+        }
+        break;
+      }
+      case Kind::kBlob: {
+        offset += ReadVarint(offset);
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+
+  /// @return offset of the payload of given node (preorder number)
+  [[nodiscard]] constexpr auto PayloadOffset(std::size_t node) const noexcept
+      -> std::size_t {
+    std::size_t offset{m_samples[node / kSampleRate]};
+    for (auto skipped{node - node % kSampleRate}; skipped < node; ++skipped) {
+      SkipPayload(KindOf(skipped), offset);
+    }
+    return offset;
+  }
+
+  BalancedParentheses m_structure{};
+  /// 4 bit Kind per node
+  std::vector<std::uint8_t> m_kinds{};
+  std::vector<std::uint8_t> m_payload{};
+  /// payload offset of every kSampleRate-th node
+  std::vector<std::uint32_t> m_samples{};
+  /// sorted distinct strings, concatenated
+  std::string m_strings{};
+  std::vector<std::uint32_t> m_string_offsets{};
+  std::size_t m_node_count{0};
+};
+
+/// position of a node in a CompactJson, cheap to copy. Accessors mirror those
+/// of Json and throw the same exceptions.
+class CompactJson::Cursor final {
+ public:
+  /// T is one of bool, double, std::monostate, std::string and the
+  /// Json::json_*_t types
+  template <class T>
+  [[nodiscard]] constexpr auto IsType() const noexcept -> bool {
+    auto const kind{NodeKind()};
+    if constexpr (std::same_as<T, bool>) {
+      return kind == Kind::kFalse or kind == Kind::kTrue;
+    } else if constexpr (std::same_as<T, double>) {
+      return kind == Kind::kInteger or kind == Kind::kDouble;
+    } else if constexpr (std::same_as<T, std::monostate>) {
+      return kind == Kind::kNull;
+    } else if constexpr (std::same_as<T, std::string>) {
+      return kind == Kind::kString;
+    } else if constexpr (std::same_as<T, Json::json_object_t>) {
+      return kind == Kind::kObject;
+    } else if constexpr (std::same_as<T, Json::json_array_t>) {
+      return kind == Kind::kArray;
+    } else {
+      static_assert(std::same_as<T, Json::json_blob_t>);
+      return kind == Kind::kBlob;
+    }
+  }
+
+  /// @return the string as written in the json text, i.e. still escaped
+  [[nodiscard]] constexpr auto GetStringView() const -> std::string_view {
+    if (not IsType<std::string>()) {
+      throw std::invalid_argument{"does not contain string value."};
+    }
+
+    auto offset{m_document->PayloadOffset(NodeIndex())};
+    return m_document->String(m_document->ReadVarint(offset));
+  }
+
+  [[nodiscard]] constexpr auto GetDouble() const -> double {
+    if (not IsType<double>()) {
+      throw std::invalid_argument{"does not contain double value."};
+    }
+
+    auto offset{m_document->PayloadOffset(NodeIndex())};
+    if (NodeKind() == Kind::kInteger) {
+      return ZigZagDecode(m_document->ReadVarint(offset));
+    }
+    std::uint64_t bits{0};
+    for (std::size_t shift{0}; shift < 64; shift += 8) {
+      bits |= std::uint64_t{m_document->m_payload[offset++]} << shift;
+    }
+    return std::bit_cast<double>(bits);
+  }
+
+  /// @return number of members of an object or elements of an array
+  /// @throws std::logic_error if neither an object nor an array
+  [[nodiscard]] constexpr auto Size() const -> std::size_t {
+    if (not IsType<Json::json_object_t>() and
+        not IsType<Json::json_array_t>()) {
+      throw std::logic_error{"json is neither an object nor an array."};
+    }
+
+    auto offset{m_document->PayloadOffset(NodeIndex())};
+    return m_document->ReadVarint(offset);
+  }
+
+  /// @return the element at index of an array. Walks the preceding siblings.
+  /// @throws std::invalid_argument if not an array or index is out of range
+  [[nodiscard]] constexpr auto At(std::size_t index) const -> Cursor {
+    if (not IsType<Json::json_array_t>()) {
+      throw std::invalid_argument{"does not contain array value."};
+    }
+    if (index >= Size()) {
+      throw std::invalid_argument{
+          fmt::format("array index {} is out of range.", index)};
+    }
+
+    return Child(index);
+  }
+
+  [[nodiscard]] constexpr auto Contains(std::string_view key) const -> bool {
+    return MemberIndex(key).has_value();
+  }
+
+  /// @throws std::logic_error if not an object
+  /// @throws std::invalid_argument if key does not exist
+  [[nodiscard]] constexpr auto GetJson(std::string_view key) const -> Cursor {
+    auto const member_index{MemberIndex(key)};
+    if (not member_index) {
+      throw std::invalid_argument{fmt::format("does not contain {} key.", key)};
+    }
+
+    return Child(*member_index);
+  }
+
+  /// decompresses the subtree
+  [[nodiscard]] constexpr auto ToJson() const -> Json {
+    auto offset{m_document->PayloadOffset(NodeIndex())};
+    switch (NodeKind()) {
+      case Kind::kNull: {
+        return Json{std::monostate{}};
+      }
+      case Kind::kFalse: {
+        return Json{false};
+      }
+      case Kind::kTrue: {
+        return Json{true};
+      }
+      case Kind::kInteger:
+      case Kind::kDouble: {
+        return Json{GetDouble()};
+      }
+      case Kind::kString: {
+        return Json{GetStringView()};
+      }
+      case Kind::kObject: {
+        auto const count{m_document->ReadVarint(offset)};
+        Json::json_object_t json_object{};
+        json_object.reserve(count);
+        auto child{*this};
+        for (std::size_t member{0}; member < count; ++member) {
+          child = member == 0 ? Child(0) : child.NextSibling();
+          json_object.try_emplace(
+              m_document->String(m_document->ReadVarint(offset)),
+              child.ToJson());
+        }
+        return Json{std::move(json_object)};
+      }
+      case Kind::kArray: {
+        auto const count{m_document->ReadVarint(offset)};
+        Json::json_array_t json_array{};
+        json_array.reserve(count);
+        auto child{*this};
+        for (std::size_t element{0}; element < count; ++element) {
+          child = element == 0 ? Child(0) : child.NextSibling();
+          json_array.push_back(child.ToJson());
+        }
+        return Json{std::move(json_array)};
+      }
+      case Kind::kBlob: {
+        Json::json_blob_t blob(m_document->ReadVarint(offset));
+        for (auto& byte : blob) {
+          byte = std::byte{m_document->m_payload[offset++]};
+        }
+        return Json{std::move(blob)};
+      }
+    }
+    std::unreachable();
+  }
+
+ private:
+  friend class CompactJson;
+
+  constexpr Cursor(CompactJson const& document, std::size_t position) noexcept
+      : m_document{&document}, m_position{position} {}
+
+  [[nodiscard]] constexpr auto NodeIndex() const noexcept -> std::size_t {
+    return m_document->m_structure.Rank(m_position);
+  }
+
+  [[nodiscard]] constexpr auto NodeKind() const noexcept -> Kind {
+    return m_document->KindOf(NodeIndex());
+  }
+
+  [[nodiscard]] constexpr auto NextSibling() const noexcept -> Cursor {
+    return Cursor{*m_document,
+                  m_document->m_structure.FindClose(m_position) + 1};
+  }
+
+  /// first child directly follows the open of its parent
+  [[nodiscard]] constexpr auto Child(std::size_t index) const noexcept
+      -> Cursor {
+    Cursor child{*m_document, m_position + 1};
+    for (; index != 0; --index) {
+      child = child.NextSibling();
+    }
+    return child;
+  }
+
+  /// @throws std::logic_error if not an object
+  [[nodiscard]] constexpr auto MemberIndex(std::string_view key) const
+      -> std::optional<std::size_t> {
+    if (not IsType<Json::json_object_t>()) {
+      throw std::logic_error{"json is not an object."};
+    }
+
+    auto const key_id{m_document->StringId(key)};
+    if (not key_id) {
+      return std::nullopt;
+    }
+    auto offset{m_document->PayloadOffset(NodeIndex())};
+    auto const count{m_document->ReadVarint(offset)};
+    for (std::size_t member{0}; member < count; ++member) {
+      if (m_document->ReadVarint(offset) == *key_id) {
+        return member;
+      }
+    }
+    return std::nullopt;
+  }
+
+  CompactJson const* m_document;
+  /// bit position of the node's open in the structure
+  std::size_t m_position;
+};
+
+constexpr auto CompactJson::Root() const noexcept -> Cursor {
+  return Cursor{*this, 0};
+}
+
+/// wire format of DeltaEncoder/DeltaDecoder. A delta is the sequence number of
+/// the document it applies to, followed by operations and a kEnd byte. Each
+/// operation addresses a value by a path of member/element indices (varint
+/// depth, then varint indices) into the previous document, which both sides
+/// share.
+enum class DeltaOp : std::uint8_t {
+  kEnd,
+  /// path, value
+  kReplace,
+  /// path of object, key, value
+  kInsertMember,
+  /// path of object, member index
+  kEraseMember,
+  /// path of array, value
+  kAppend,
+  /// path of array, new size
+  kTruncate
+};
+
+enum class DeltaValueTag : std::uint8_t {
+  kNull,
+  kFalse,
+  kTrue,
+  kInteger,
+  kDouble,
+  kString,
+  kObject,
+  kArray,
+  kBlob
+};
+
+class DeltaWriter final {
+ public:
+  constexpr auto Byte(std::uint8_t value) -> void {
+    m_bytes.push_back(std::byte{value});
+  }
+
+  constexpr auto Varint(std::uint64_t value) -> void {
+    for (; value >= 0x80; value >>= 7) {
+      Byte(static_cast<std::uint8_t>(value | 0x80));
+    }
+    Byte(static_cast<std::uint8_t>(value));
+  }
+
+  constexpr auto String(std::string_view value) -> void {
+    Varint(rng::size(value));
+    for (auto const c : value) {
+      m_bytes.push_back(static_cast<std::byte>(c));
+    }
+  }
+
+  constexpr auto Op(DeltaOp op, std::span<std::size_t const> path) -> void {
+    Byte(std::to_underlying(op));
+    Varint(rng::size(path));
+    for (auto const index : path) {
+      Varint(index);
+    }
+  }
+
+  constexpr auto Value(Json const& json) -> void;
+
+  [[nodiscard]] constexpr auto Take() && -> std::vector<std::byte> {
+    return std::move(m_bytes);
+  }
+
+ private:
+  constexpr auto Tag(DeltaValueTag tag) -> void {
+    Byte(std::to_underlying(tag));
+  }
+
+  std::vector<std::byte> m_bytes{};
+};
+
+class DeltaReader final {
+ public:
+  constexpr explicit DeltaReader(std::span<std::byte const> bytes) noexcept
+      : m_bytes{bytes} {}
+
+  [[nodiscard]] constexpr auto AtEnd() const noexcept -> bool {
+    return rng::empty(m_bytes);
+  }
+
+  /// @throws std::invalid_argument if the delta is truncated
+  [[nodiscard]] constexpr auto Byte() -> std::uint8_t {
+    if (rng::empty(m_bytes)) {
+      throw std::invalid_argument{"Delta is truncated."};
+    }
+    auto const value{std::to_integer<std::uint8_t>(m_bytes.front())};
+    m_bytes = m_bytes.subspan(1);
+    return value;
+  }
+
+  [[nodiscard]] constexpr auto Varint() -> std::uint64_t {
+    std::uint64_t value{0};
+    for (std::size_t shift{0}; shift < 64; shift += 7) {
+      auto const byte{Byte()};
+      value |= std::uint64_t{byte & 0x7fu} << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw std::invalid_argument{"Delta has a malformed varint."};
+  }
+
+  [[nodiscard]] constexpr auto Bytes(std::uint64_t size)
+      -> std::span<std::byte const> {
+    if (size > rng::size(m_bytes)) {
+      throw std::invalid_argument{"Delta is truncated."};
+    }
+    auto const bytes{m_bytes.first(size)};
+    m_bytes = m_bytes.subspan(size);
+    return bytes;
+  }
+
+  [[nodiscard]] constexpr auto String() -> std::string {
+    auto const bytes{Bytes(Varint())};
+    std::string value(rng::size(bytes), '\0');
+    rng::transform(bytes, rng::begin(value),
+                   [](std::byte byte) { return static_cast<char>(byte); });
+    return value;
+  }
+
+  [[nodiscard]] constexpr auto Value() -> Json;
+
+ private:
+  std::span<std::byte const> m_bytes;
+};
+
+constexpr auto DeltaWriter::Value(Json const& json) -> void {
+  if (json.IsType<bool>()) {
+    Tag(json == Json{true} ? DeltaValueTag::kTrue : DeltaValueTag::kFalse);
+  } else if (json.IsType<std::monostate>()) {
+    Tag(DeltaValueTag::kNull);
+  } else if (json.IsType<double>()) {
+    if (auto const value{json.GetDouble()}; IsVarintNumber(value)) {
+      Tag(DeltaValueTag::kInteger);
+      Varint(ZigZagEncode(value));
+    } else {
+      Tag(DeltaValueTag::kDouble);
+      auto const bits{std::bit_cast<std::uint64_t>(value)};
+      for (std::size_t shift{0}; shift < 64; shift += 8) {
+        Byte(static_cast<std::uint8_t>(bits >> shift));
+      }
+    }
+  } else if (json.IsType<std::string>()) {
+    Tag(DeltaValueTag::kString);
+    String(json.GetStringView());
+  } else if (json.IsType<Json::json_object_t>()) {
+    Tag(DeltaValueTag::kObject);
+    Varint(rng::size(json.GetMap()));
+    for (auto const& [key, value] : json.GetMap()) {
+      String(key);
+      Value(value);
+    }
+  } else if (json.IsType<Json::json_array_t>()) {
+    Tag(DeltaValueTag::kArray);
+    Varint(rng::size(json.GetArray()));
+    for (auto const& element : json.GetArray()) {
+      Value(element);
+    }
+  } else {
+    std::vector<std::byte> buffer{};
+    auto const blob{json.GetBytes(buffer)};
+    Tag(DeltaValueTag::kBlob);
+    Varint(rng::size(blob));
+    m_bytes.insert(rng::end(m_bytes), rng::begin(blob), rng::end(blob));
+  }
+}
+
+constexpr auto DeltaReader::Value() -> Json {
+  switch (static_cast<DeltaValueTag>(Byte())) {
+    case DeltaValueTag::kNull: {
+      return Json{std::monostate{}};
+    }
+    case DeltaValueTag::kFalse: {
+      return Json{false};
+    }
+    case DeltaValueTag::kTrue: {
+      return Json{true};
+    }
+    case DeltaValueTag::kInteger: {
+      return Json{ZigZagDecode(Varint())};
+    }
+    case DeltaValueTag::kDouble: {
+      std::uint64_t bits{0};
+      for (std::size_t shift{0}; shift < 64; shift += 8) {
+        bits |= std::uint64_t{Byte()} << shift;
+      }
+      return Json{std::bit_cast<double>(bits)};
+    }
+    case DeltaValueTag::kString: {
+      return Json{std::string_view{String()}};
+    }
+    case DeltaValueTag::kObject: {
+      auto const count{Varint()};
+      Json::json_object_t json_object{};
+      json_object.reserve(std::min(count, std::uint64_t{rng::size(m_bytes)}));
+      for (std::uint64_t member{0}; member < count; ++member) {
+        auto key{String()};
+        json_object.try_emplace(key, Value());
+      }
+      return Json{std::move(json_object)};
+    }
+    case DeltaValueTag::kArray: {
+      auto const count{Varint()};
+      Json::json_array_t json_array{};
+      json_array.reserve(std::min(count, std::uint64_t{rng::size(m_bytes)}));
+      for (std::uint64_t element{0}; element < count; ++element) {
+        json_array.push_back(Value());
+      }
+      return Json{std::move(json_array)};
+    }
+    case DeltaValueTag::kBlob: {
+      auto const bytes{Bytes(Varint())};
+      return Json{Json::json_blob_t(rng::begin(bytes), rng::end(bytes))};
+    }
+  }
+  throw std::invalid_argument{"Delta has an unknown value tag."};
+}
+
+/// receiving side of DeltaEncoder: keeps the previous document and patches it
+/// in place with each delta, so unchanged values are neither transferred nor
+/// parsed again.
+///
+/// ```cpp
+/// uzleo::json::DeltaDecoder decoder{};
+/// for (auto const& message : messages) {
+///   Json const& document{decoder.Apply(message)};
+/// }
+/// ```
+export class DeltaDecoder final {
+ public:
+  /// patches the current document with delta. If this throws, the document
+  /// is left partially patched and later deltas are rejected.
+  /// @return the patched document
+  /// @throws std::invalid_argument if delta is malformed or was not encoded
+  /// against the current document
+  constexpr auto Apply(std::span<std::byte const> delta) -> Json const& {
+    if (m_broken) {
+      throw std::invalid_argument{"Delta stream broke on an earlier delta."};
+    }
+    DeltaReader reader{delta};
+    if (reader.Varint() != m_sequence) {
+      throw std::invalid_argument{
+          "Delta does not follow the previous document."};
+    }
+    // rejects later deltas unless this one applies completely
+    m_broken = true;
+
+    for (auto op{reader.Byte()}; op != std::to_underlying(DeltaOp::kEnd);
+         op = reader.Byte()) {
+      auto& target{Resolve(reader)};
+      switch (static_cast<DeltaOp>(op)) {
+        case DeltaOp::kReplace: {
+          target = reader.Value();
+          break;
+        }
+        case DeltaOp::kInsertMember: {
+          auto key{reader.String()};
+          if (not ObjectOf(target).try_emplace(key, reader.Value()).second) {
+            throw std::invalid_argument{"Delta inserts an existing member."};
+          }
+          break;
+        }
+        case DeltaOp::kEraseMember: {
+          auto& json_object{ObjectOf(target)};
+          auto const index{reader.Varint()};
+          if (index >= rng::size(json_object)) {
+            throw std::invalid_argument{"Delta has an invalid path."};
+          }
+          json_object.erase(std::string{rng::next(
+              rng::begin(json_object), static_cast<std::ptrdiff_t>(index))
+                                            ->first});
+          break;
+        }
+        case DeltaOp::kAppend: {
+          ArrayOf(target).push_back(reader.Value());
+          break;
+        }
+        case DeltaOp::kTruncate: {
+          auto& json_array{ArrayOf(target)};
+          if (auto const size{reader.Varint()};
+              size <= rng::size(json_array)) {
+            json_array.erase(rng::next(rng::begin(json_array),
+                                       static_cast<std::ptrdiff_t>(size)),
+                             rng::end(json_array));
+          } else {
+            throw std::invalid_argument{"Delta has an invalid path."};
+          }
+          break;
+        }
+        default: {
+          throw std::invalid_argument{"Delta has an unknown operation."};
+        }
+      }
+    }
+    if (not reader.AtEnd()) {
+      throw std::invalid_argument{"Delta has trailing bytes."};
+    }
+
+    ++m_sequence;
+    m_broken = false;
+    return m_document;
+  }
+
+  [[nodiscard]] constexpr auto Document() const noexcept -> Json const& {
+    return m_document;
+  }
+
+  /// @return sequence number the next delta must carry
+  [[nodiscard]] constexpr auto Sequence() const noexcept -> std::uint64_t {
+    return m_sequence;
+  }
+
+ private:
+  [[nodiscard]] static constexpr auto ObjectOf(Json& json)
+      -> Json::json_object_t& {
+    if (not json.IsType<Json::json_object_t>()) {
+      throw std::invalid_argument{"Delta has an invalid path."};
+    }
+    return std::get<Json::json_object_t>(json.m_value);
+  }
+
+  [[nodiscard]] static constexpr auto ArrayOf(Json& json)
+      -> Json::json_array_t& {
+    if (not json.IsType<Json::json_array_t>()) {
+      throw std::invalid_argument{"Delta has an invalid path."};
+    }
+    return std::get<Json::json_array_t>(json.m_value);
+  }
+
+  /// reads a path and walks it from the document root
+  [[nodiscard]] constexpr auto Resolve(DeltaReader& reader) -> Json& {
+    auto* json{&m_document};
+    for (auto depth{reader.Varint()}; depth != 0; --depth) {
+      auto const index{reader.Varint()};
+      if (json->IsType<Json::json_object_t>()) {
+        auto& json_object{ObjectOf(*json)};
+        if (index >= rng::size(json_object)) {
+          throw std::invalid_argument{"Delta has an invalid path."};
+        }
+        json = &json_object.at(rng::next(rng::begin(json_object),
+                                         static_cast<std::ptrdiff_t>(index))
+                                   ->first);
+      } else {
+        auto& json_array{ArrayOf(*json)};
+        if (index >= rng::size(json_array)) {
+          throw std::invalid_argument{"Delta has an invalid path."};
+        }
+        json = &json_array[index];
       }
-      case 't': {
-        if (tmp_view.starts_with("true")) {
-          token_stream.emplace_back(TokenType::kTrue, tmp_view.substr(0, 4));
+    }
+    return *json;
+  }
+
+  Json m_document{std::monostate{}};
+  std::uint64_t m_sequence{0};
+  /// set once a delta failed to apply
+  bool m_broken{false};
+};
+
+/// sending side of a delta stream between consecutive, mostly unchanged
+/// documents, e.g. telemetry sent every second. Encode() emits only the
+/// changed values, addressed by member/element indices into the previous
+/// document; the first delta carries the whole document. Deltas have to be
+/// applied in order by a DeltaDecoder that has seen all previous ones.
+export class DeltaEncoder final {
+ public:
+  /// @return delta that turns the previous document into json
+  constexpr auto Encode(Json const& json) -> std::vector<std::byte> {
+    DeltaWriter writer{};
+    writer.Varint(m_state.Sequence());
+    std::vector<std::size_t> path{};
+
+    auto const diff_json{[&](this auto const& self, Json const& old_json,
+                             Json const& new_json) -> void {
+      if (old_json.IsType<Json::json_object_t>() and
+          new_json.IsType<Json::json_object_t>()) {
+        auto const& old_map{old_json.GetMap()};
+        auto const& new_map{new_json.GetMap()};
+
+        std::vector<std::size_t> erased{};
+        for (std::size_t index{0}; auto const& [key, value] : old_map) {
+          if (auto const citer{new_map.find(key)};
+              citer != rng::cend(new_map)) {
+            path.push_back(index);
+            self(value, citer->second);
+            path.pop_back();
+          } else {
+            erased.push_back(index);
+          }
+          ++index;
+        }
+        // from the back, as erasing moves the last member into the gap
+        for (auto const index : erased | std::views::reverse) {
+          writer.Op(DeltaOp::kEraseMember, path);
+          writer.Varint(index);
+        }
+        for (auto const& [key, value] : new_map) {
+          if (not old_map.contains(key)) {
+            writer.Op(DeltaOp::kInsertMember, path);
+            writer.String(key);
+            writer.Value(value);
+          }
+        }
+        return;
+      }
+
+      if (old_json.IsType<Json::json_array_t>() and
+          new_json.IsType<Json::json_array_t>()) {
+        auto const old_array{old_json.GetArray()};
+        auto const new_array{new_json.GetArray()};
+        for (std::size_t index{0};
+             index < std::min(rng::size(old_array), rng::size(new_array));
+             ++index) {
+          path.push_back(index);
+          self(old_array[index], new_array[index]);
+          path.pop_back();
+        }
+        if (rng::size(old_array) > rng::size(new_array)) {
+          writer.Op(DeltaOp::kTruncate, path);
+          writer.Varint(rng::size(new_array));
+        }
+        for (auto const& element : new_array.subspan(
+                 std::min(rng::size(old_array), rng::size(new_array)))) {
+          writer.Op(DeltaOp::kAppend, path);
+          writer.Value(element);
+        }
+        return;
+      }
+
+      if (not(old_json == new_json) or
+          (old_json.IsType<double>() and
+           std::signbit(old_json.GetDouble()) !=
+               std::signbit(new_json.GetDouble()))) {
+        writer.Op(DeltaOp::kReplace, path);
+        writer.Value(new_json);
+      }
+    }};
+
+    diff_json(m_state.Document(), json);
+    writer.Byte(std::to_underlying(DeltaOp::kEnd));
+    auto delta{std::move(writer).Take()};
+    // keeps the encoder's copy of the document in step with the receiver's
+    std::ignore = m_state.Apply(delta);
+    return delta;
+  }
+
+ private:
+  DeltaDecoder m_state{};
+};
+
+export struct NdjsonSortOptions {
+  /// input bytes sorted in memory at once. Larger inputs are sorted in runs of
+  /// about this size, spilled to temporary files and merged.
+  std::size_t memory_budget{std::size_t{256} << 20};
+  /// threads extracting keys and sorting a run, 0 for one per hardware thread
+  std::size_t thread_count{0};
+  /// directory of the spilled runs, the directory of the output if empty
+  std::filesystem::path temp_directory{};
+  /// fsync the output, see DumpFileOptions::sync
+  bool sync{true};
+};
+
+/// sort key of an NDJSON record: records without the key come first, then
+/// null, false, true, numbers (by value), strings and containers (by their
+/// raw text)
+struct NdjsonSortKey {
+  enum class Rank : std::uint8_t {
+    kMissing,
+    kNull,
+    kFalse,
+    kTrue,
+    kNumber,
+    kString,
+    kContainer
+  };
+
+  Rank rank{Rank::kMissing};
+  double number{0.0};
+  std::string_view text{};
+
+  [[nodiscard]] friend constexpr auto operator<(NdjsonSortKey const& lhs,
+                                                NdjsonSortKey const& rhs)
+      -> bool {
+    if (lhs.rank != rhs.rank) {
+      return lhs.rank < rhs.rank;
+    }
+    if (lhs.rank == Rank::kNumber) {
+      return lhs.number < rhs.number;
+    }
+    return lhs.text < rhs.text;
+  }
+};
+
+/// @return size of the json value at the start of text, found without
+/// building it. Containers are skipped by counting brackets outside strings.
+/// @throws std::invalid_argument for unterminated strings or containers
+[[nodiscard]] auto SkipRawValue(std::string_view text) -> std::size_t {
+  auto const string_end{[text](std::size_t position) {
+    while (position < rng::size(text)) {
+      position += FindQuoteOrBackslash(text.substr(position));
+      if (position < rng::size(text) and text[position] == '"') {
+        return position + 1;
+      }
+      // skips the backslash and the escaped character, which may be beyond
+      // the end of a record ending in a lone backslash
+      position += 2;
+    }
+    throw std::invalid_argument{"Unterminated string in json record."};
+  }};
+
+  if (rng::empty(text)) {
+    throw std::invalid_argument{"Missing value in json record."};
+  }
+  if (text.front() == '"') {
+    return string_end(1);
+  }
+  if (text.front() == '{' or text.front() == '[') {
+    std::size_t depth{0};
+    for (std::size_t position{0}; position < rng::size(text);) {
+      switch (text[position]) {
+        case '"': {
+          position = string_end(position + 1);
+          continue;
+        }
+        case '{':
+        case '[': {
+          ++depth;
+          break;
+        }
+        case '}':
+        case ']': {
+          if (--depth == 0) {
+            return position + 1;
+          }
+          break;
+        }
+        default: {
+          break;
+        }
+      }
+      ++position;
+    }
+    throw std::invalid_argument{"Unterminated container in json record."};
+  }
+  return std::min(text.find_first_of(",}] \t\r\n"), rng::size(text));
+}
+
+/// @return raw text of the value at the json pointer given as segments, found
+/// by skipping over everything else. Keys are compared as written, i.e.
+/// escaped.
+/// @throws std::invalid_argument for malformed records
+[[nodiscard]] auto FindRawValue(std::string_view record,
+                                std::span<std::string const> segments)
+    -> std::optional<std::string_view> {
+  auto const skip_whitespace{[&record] {
+    record.remove_prefix(SkipWhitespace(record));
+  }};
+  auto const expect{[&record](char c) {
+    if (rng::empty(record) or record.front() != c) {
+      throw std::invalid_argument{
+          fmt::format("Malformed json record, expected '{}'.", c)};
+    }
+    record.remove_prefix(1);
+  }};
+
+  for (auto const& segment : segments) {
+    skip_whitespace();
+    if (rng::empty(record) or
+        (record.front() != '{' and record.front() != '[')) {
+      return std::nullopt;
+    }
+    auto const is_object{record.front() == '{'};
+    auto const closing{is_object ? '}' : ']'};
+    std::size_t requested_index{std::numeric_limits<std::size_t>::max()};
+    if (not is_object) {
+      auto const* const end{rng::data(segment) + rng::size(segment)};
+      if (auto const [ptr, ec]{
+              std::from_chars(rng::data(segment), end, requested_index)};
+          ec != std::errc{} or ptr != end) {
+        return std::nullopt;
+      }
+    }
+    record.remove_prefix(1);
+
+    for (std::size_t index{0};; ++index) {
+      skip_whitespace();
+      if (not rng::empty(record) and record.front() == closing) {
+        return std::nullopt;
+      }
+      auto found{index == requested_index};
+      if (is_object) {
+        if (rng::empty(record) or record.front() != '"') {
+          throw std::invalid_argument{
+              "Malformed json record, expected a member key."};
+        }
+        auto const key_size{SkipRawValue(record)};
+        found = record.substr(1, key_size - 2) == segment;
+        record.remove_prefix(key_size);
+        skip_whitespace();
+        expect(':');
+        skip_whitespace();
+      }
+      if (found) {
+        break;
+      }
+
+      record.remove_prefix(SkipRawValue(record));
+      skip_whitespace();
+      if (not rng::empty(record) and record.front() == ',') {
+        record.remove_prefix(1);
+      } else {
+        expect(closing);
+        return std::nullopt;
+      }
+    }
+  }
+
+  skip_whitespace();
+  return record.substr(0, SkipRawValue(record));
+}
+
+[[nodiscard]] auto ExtractSortKey(std::string_view record,
+                                  std::span<std::string const> segments)
+    -> NdjsonSortKey {
+  using enum NdjsonSortKey::Rank;
+
+  auto const raw_value{FindRawValue(record, segments)};
+  if (not raw_value or rng::empty(*raw_value)) {
+    return NdjsonSortKey{};
+  }
+  auto const literal{[&raw_value](std::string_view expected,
+                                  NdjsonSortKey::Rank rank) {
+    if (*raw_value != expected) {
+      throw std::invalid_argument{"Malformed literal in json record."};
+    }
+    return NdjsonSortKey{.rank = rank};
+  }};
+  switch (raw_value->front()) {
+    case 'n': {
+      return literal("null", kNull);
+    }
+    case 'f': {
+      return literal("false", kFalse);
+    }
+    case 't': {
+      return literal("true", kTrue);
+    }
+    case '"': {
+      return NdjsonSortKey{
+          .rank = kString,
+          .text = raw_value->substr(1, rng::size(*raw_value) - 2)};
+    }
+    case '{':
+    case '[': {
+      return NdjsonSortKey{.rank = kContainer, .text = *raw_value};
+    }
+    default: {
+      // ParseNumber() would also take inf and nan, and throws
+      // std::runtime_error
+      if (auto const front{raw_value->front()};
+          front != '-' and (front < '0' or front > '9')) {
+        throw std::invalid_argument{"Malformed number in json record."};
+      }
+      try {
+        return NdjsonSortKey{.rank = kNumber,
+                             .number = ParseNumber(*raw_value)};
+      } catch (std::runtime_error const&) {
+        throw std::invalid_argument{"Malformed number in json record."};
+      }
+    }
+  }
+}
+
+struct NdjsonRecord {
+  NdjsonSortKey key{};
+  std::string_view text{};
+};
+
+/// extracts the keys of records and stable-sorts them, both split over
+/// thread_count threads. The sorted parts are then merged pairwise.
+/// @throws what key extraction throws for malformed records
+auto SortNdjsonRecords(std::vector<NdjsonRecord>& records,
+                       std::span<std::string const> segments,
+                       std::size_t thread_count) -> void {
+  static constexpr std::size_t kMinPartSize{4096};
+  static constexpr auto key_less{
+      [](NdjsonRecord const& lhs, NdjsonRecord const& rhs) {
+        return lhs.key < rhs.key;
+      }};
+
+  auto const part_count{std::clamp(rng::size(records) / kMinPartSize,
+                                   std::size_t{1}, thread_count)};
+  std::vector<std::size_t> bounds{};
+  for (std::size_t part{0}; part <= part_count; ++part) {
+    bounds.push_back(part * rng::size(records) / part_count);
+  }
+
+  std::vector<std::exception_ptr> errors(part_count);
+  auto const sort_part{[&](std::size_t part) {
+    try {
+      auto const part_records{std::span{records}.subspan(
+          bounds[part], bounds[part + 1] - bounds[part])};
+      for (auto& record : part_records) {
+        record.key = ExtractSortKey(record.text, segments);
+      }
+      rng::stable_sort(part_records, key_less);
+    } catch (...) {
+      errors[part] = std::current_exception();
+    }
+  }};
+  {
+    std::vector<std::jthread> threads{};
+    for (std::size_t part{1}; part < part_count; ++part) {
+      threads.emplace_back(sort_part, part);
+    }
+    sort_part(0);
+  }
+  for (auto const& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  auto const begin{rng::begin(records)};
+  for (std::size_t width{1}; width < part_count; width *= 2) {
+    for (std::size_t part{0}; part + width < part_count; part += 2 * width) {
+      std::inplace_merge(
+          begin + static_cast<std::ptrdiff_t>(bounds[part]),
+          begin + static_cast<std::ptrdiff_t>(bounds[part + width]),
+          begin + static_cast<std::ptrdiff_t>(
+                      bounds[std::min(part + 2 * width, part_count)]),
+          key_less);
+    }
+  }
+}
+
+/// removes the spilled runs of a sort, also when it fails
+class TemporaryFiles final {
+ public:
+  TemporaryFiles() = default;
+  TemporaryFiles(TemporaryFiles const&) = delete;
+  auto operator=(TemporaryFiles const&) -> TemporaryFiles& = delete;
+
+  ~TemporaryFiles() {
+    for (auto const& path : m_paths) {
+      std::error_code error_code{};
+      std::filesystem::remove(path, error_code);
+    }
+  }
 
-          rng::advance(citer, 4, json_content_end_iter);
-          break;
-        }
+  auto Add(std::filesystem::path path) -> std::filesystem::path const& {
+    return m_paths.emplace_back(std::move(path));
+  }
 
-        throw std::invalid_argument{"Failed to lex true."};
-      }
-      case 'n': {
-        if (tmp_view.starts_with("null")) {
-          token_stream.emplace_back(TokenType::kNull, tmp_view.substr(0, 4));
+  [[nodiscard]] auto Paths() const noexcept
+      -> std::span<std::filesystem::path const> {
+    return m_paths;
+  }
 
-          rng::advance(citer, 4, json_content_end_iter);
-          break;
-        }
+ private:
+  std::vector<std::filesystem::path> m_paths{};
+};
 
-        throw std::invalid_argument{"Failed to lex null."};
-      }
-      case '"': {
-        if (auto json_string_end_iter{rng::find_if(
-                rng::next(rng::begin(tmp_view), 1, rng::end(tmp_view)),
-                rng::end(tmp_view),
-                [escaped = false](char c) mutable {
-                  if (escaped) {
-                    escaped = false;
-                    return false;
-                  }
-                  if (c == '\\') {
-                    escaped = true;
-                    return false;
-                  }
-
-                  return (c == '"');
-                })};
-            json_string_end_iter != rng::end(tmp_view)) {
-          rng::advance(json_string_end_iter, 1, rng::end(tmp_view));
+/// k-way merges sorted runs into sink. On equal keys the earlier run wins,
+/// which keeps the merge stable.
+/// @throws std::runtime_error if a run can not be read
+auto MergeNdjsonRuns(std::span<std::filesystem::path const> run_paths,
+                     std::span<std::string const> segments,
+                     AtomicFileSink& sink) -> void {
+  struct RunCursor {
+    std::ifstream stream;
+    std::string line{};
+    NdjsonSortKey key{};
+  };
+  std::vector<RunCursor> cursors{};
+  // key views into the lines must stay valid
+  cursors.reserve(rng::size(run_paths));
+  auto const advance{[segments](RunCursor& cursor) {
+    if (not std::getline(cursor.stream, cursor.line)) {
+      return false;
+    }
+    cursor.key = ExtractSortKey(cursor.line, segments);
+    return true;
+  }};
+  auto const greater{[&cursors](std::size_t lhs, std::size_t rhs) {
+    if (cursors[rhs].key < cursors[lhs].key) {
+      return true;
+    }
+    return not(cursors[lhs].key < cursors[rhs].key) and lhs > rhs;
+  }};
+  std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)>
+      heap{greater};
+  for (auto const& path : run_paths) {
+    auto& cursor{cursors.emplace_back(
+        RunCursor{.stream = std::ifstream{path, std::ios::binary}})};
+    if (not cursor.stream.is_open()) {
+      throw std::runtime_error{
+          fmt::format("Failed to open {}.", path.string())};
+    }
+    if (advance(cursor)) {
+      heap.push(rng::size(cursors) - 1);
+    }
+  }
 
-          // this is pointing to string that include the quotation marks
-          // e.g. for a json string "foo", the lexeme_with_commas_size is
-          // 3(foo)+2("") = 5
-          auto const lexeme_with_commas_size{
-              rng::distance(rng::begin(tmp_view), json_string_end_iter)};
-          token_stream.emplace_back(
-              TokenType::kString,
-              tmp_view.substr(1, lexeme_with_commas_size - 2));
+  while (not rng::empty(heap)) {
+    auto const index{heap.top()};
+    heap.pop();
+    sink(cursors[index].line);
+    sink("\n");
+    if (advance(cursors[index])) {
+      heap.push(index);
+    }
+  }
+}
 
-          rng::advance(citer, lexeme_with_commas_size, json_content_end_iter);
-          break;
-        }
+/// sorts the records (lines) of an NDJSON file by the value at key_pointer
+/// with bounded memory. The input is read in runs of
+/// options.memory_budget bytes. For each run, the sort keys are extracted
+/// from the raw record text, without parsing the records, and the run is
+/// sorted on several threads and spilled to a temporary file. The runs are
+/// then k-way merged into output. Records are copied byte for byte; the sort
+/// is stable and empty lines are dropped. The output is replaced atomically
+/// like by DumpToFile().
+/// @return number of records written
+/// @throws std::invalid_argument for an invalid key_pointer or malformed
+/// records, std::runtime_error if files can not be read or written
+export auto SortNdjson(std::filesystem::path&& input_path,
+                       std::filesystem::path&& output_path,
+                       std::string_view key_pointer,
+                       NdjsonSortOptions const& options = {}) -> std::size_t {
+  static constexpr std::size_t kWriteBufferSize{std::size_t{1} << 20};
+  static constexpr std::size_t kMaxMergeWidth{64};
 
-        throw std::invalid_argument{"Failed to lex string."};
-      }
-      case ':': {
-        token_stream.emplace_back(TokenType::kColon);
+  std::vector<std::string> segments{};
+  for (JsonPointerSegments pointer_segments{key_pointer};
+       auto const segment{pointer_segments.Next()};) {
+    segments.emplace_back(*segment);
+  }
 
-        rng::advance(citer, 1, json_content_end_iter);
-        break;
-      }
-      case ',': {
-        token_stream.emplace_back(TokenType::kComma);
+  std::ifstream input{input_path, std::ios::binary};
+  if (not input.is_open()) {
+    throw std::runtime_error{
+        fmt::format("Failed to open {}.", input_path.string())};
+  }
+  auto const thread_count{
+      options.thread_count != 0
+          ? options.thread_count
+          : std::max(std::size_t{1},
+                     std::size_t{std::thread::hardware_concurrency()})};
+  auto const temp_directory{
+      not options.temp_directory.empty() ? options.temp_directory
+      : output_path.parent_path().empty() ? std::filesystem::path{"."}
+                                          : output_path.parent_path()};
+  auto const run_prefix{fmt::format("{}.{:x}.run",
+                                    output_path.filename().string(),
+                                    std::random_device{}())};
 
-        rng::advance(citer, 1, json_content_end_iter);
-        break;
+  TemporaryFiles runs{};
+  auto const next_run_path{[&] {
+    return runs.Add(temp_directory / fmt::format("{}{}", run_prefix,
+                                                 rng::size(runs.Paths())));
+  }};
+  std::string run{};
+  std::string pending{};
+  std::vector<NdjsonRecord> records{};
+  std::size_t record_count{0};
+  while (true) {
+    // reads a budget's worth after the incomplete line of the last run
+    run.assign(pending);
+    pending.clear();
+    auto const kept{rng::size(run)};
+    run.resize_and_overwrite(
+        kept + std::max(options.memory_budget, std::size_t{1}),
+        [&input, kept](char* data, std::size_t size) {
+          input.read(data + kept, static_cast<std::streamsize>(size - kept));
+          return kept + static_cast<std::size_t>(input.gcount());
+        });
+    if (input.bad()) {
+      throw std::runtime_error{
+          fmt::format("Failed to read {}.", input_path.string())};
+    }
+    auto const at_end{input.eof()};
+    if (not at_end) {
+      auto const last_newline{run.rfind('\n')};
+      if (last_newline == std::string::npos) {
+        // a single record larger than the budget
+        pending = std::move(run);
+        continue;
       }
-      case '[': {
-        token_stream.emplace_back(TokenType::kLeftBracket);
+      pending.assign(std::string_view{run}.substr(last_newline + 1));
+      run.resize(last_newline + 1);
+    }
 
-        rng::advance(citer, 1, json_content_end_iter);
-        break;
+    records.clear();
+    for (auto const line : run | std::views::split('\n')) {
+      if (std::string_view const text{line};
+          SkipWhitespace(text) != rng::size(text)) {
+        records.push_back(NdjsonRecord{.text = text});
       }
-      case ']': {
-        token_stream.emplace_back(TokenType::kRightBracket);
+    }
+    SortNdjsonRecords(records, segments, thread_count);
+    record_count += rng::size(records);
 
-        rng::advance(citer, 1, json_content_end_iter);
-        break;
+    auto const write_records{[&records](AtomicFileSink& sink) {
+      for (auto const& record : records) {
+        sink(record.text);
+        sink("\n");
       }
-      default: {
-        if (in_number(*citer)) {
-          auto number_end_iter{rng::find_if_not(tmp_view, in_number)};
-          auto const lexeme_size{
-              rng::distance(rng::begin(tmp_view), number_end_iter)};
-          token_stream.emplace_back(TokenType::kNumber,
-                                    tmp_view.substr(0, lexeme_size));
-
-          rng::advance(citer, lexeme_size, json_content_end_iter);
-          break;
-        }
-
-        if (std::isspace(*citer)) {
-          rng::advance(citer, 1, json_content_end_iter);
-          break;
-        }
+    }};
+    if (at_end and rng::empty(runs.Paths())) {
+      // everything fit into memory
+      AtomicFileSink sink{output_path, kWriteBufferSize};
+      write_records(sink);
+      sink.Commit(options.sync);
+      return record_count;
+    }
+    if (not rng::empty(records)) {
+      AtomicFileSink sink{next_run_path(), kWriteBufferSize};
+      write_records(sink);
+      sink.Commit(false);
+    }
+    if (at_end) {
+      break;
+    }
+  }
+  run = std::string{};
+  records = std::vector<NdjsonRecord>{};
 
-        throw std::invalid_argument{
-            fmt::format("Failed to lex character: {}", *citer)};
+  // each open run holds a file descriptor, so many runs are first merged in
+  // passes over consecutive groups, which keeps the sort stable
+  std::vector<std::filesystem::path> current{rng::begin(runs.Paths()),
+                                             rng::end(runs.Paths())};
+  while (rng::size(current) > kMaxMergeWidth) {
+    std::vector<std::filesystem::path> merged{};
+    for (std::size_t first{0}; first < rng::size(current);
+         first += kMaxMergeWidth) {
+      auto const group{std::span{current}.subspan(
+          first, std::min(kMaxMergeWidth, rng::size(current) - first))};
+      AtomicFileSink sink{merged.emplace_back(next_run_path()),
+                          kWriteBufferSize};
+      MergeNdjsonRuns(group, segments, sink);
+      sink.Commit(false);
+      for (auto const& path : group) {
+        std::filesystem::remove(path);
       }
     }
+    current = std::move(merged);
   }
 
-  return std::make_tuple(std::move(json_content_ptr), std::move(token_stream));
+  AtomicFileSink sink{output_path, kWriteBufferSize};
+  MergeNdjsonRuns(current, segments, sink);
+  sink.Commit(options.sync);
+  return record_count;
 }
 
-constexpr auto ParseTokens(std::tuple<std::shared_ptr<std::string const>,
-                                      TokenStream>&& token_stream_with_buffer)
-    -> Json {
-  auto const parse{[](this auto const& self,
-                      std::span<Token const> token_stream_span)
-                       -> std::pair<Json, std::span<Token const>> {
-    using enum TokenType;
+/// replaces removed bytes at offset of a text with inserted
+export struct TextEdit {
+  std::size_t offset{0};
+  std::size_t removed{0};
+  std::string_view inserted{};
+};
 
-    if (rng::size(token_stream_span) == 0) {
-      throw std::invalid_argument(
-          "Recursive parse called with empty token-stream.");
-    }
+/// [begin, end) byte offsets of a value in a text
+export struct SourceRange {
+  std::size_t begin{0};
+  std::size_t end{0};
 
-    Json ret_json{std::monostate{}};
-    // switch is responsible for creating the json instance that will be
-    // returned as .first
-    switch (token_stream_span.front().type) {
-      case kLeftBrace: {
-        token_stream_span = token_stream_span.subspan(1);
+  [[nodiscard]] friend constexpr auto operator==(SourceRange const& lhs,
+                                                 SourceRange const& rhs)
+      -> bool = default;
+};
 
-        Json::json_object_t inner_json{};
-        while (true) {
-          if (token_stream_span.front().type == kRightBrace) {
-            ret_json = Json{std::move(inner_json)};
-            break;
-          }
+/// source range of a value and of the members/elements it contains, parallel
+/// to the Json tree. Offsets are relative to the parent value, so an edit
+/// only shifts the following siblings of the edited value and of its
+/// ancestors, not their whole subtrees.
+struct SourceNode {
+  /// from the begin of the parent value, or of the text for the root
+  std::size_t offset{0};
+  std::size_t size{0};
+  /// one per member/element, in document order. Members dropped as
+  /// duplicate keys have none.
+  std::vector<SourceNode> children{};
+};
 
-          if (token_stream_span.at(0).type == kString and
-              token_stream_span.at(1).type == kColon) {
-            auto const parse_result_key{self(token_stream_span)};
-            token_stream_span = parse_result_key.second.subspan(1);
+/// a json document together with its text and the source range of every
+/// value, for editors that re-parse after each small edit. Apply() re-parses
+/// only the smallest container enclosing an edit and splices the new subtree
+/// into the document. Members stay in document order (there is no sorted
+/// layout).
+///
+/// ```cpp
+/// auto document{uzleo::json::EditableJson::FromContent(text)};
+/// document.Apply({.offset = 120, .removed = 1, .inserted = "7"});
+/// use(document.GetJson(), document.RangeOf("/a/0"));
+/// ```
+export class EditableJson final {
+ public:
+  /// @throws std::invalid_argument/std::runtime_error for malformed json
+  [[nodiscard]] static constexpr auto FromContent(std::string content)
+      -> EditableJson {
+    auto [json, root]{Build(content)};
+    return EditableJson{std::move(content), std::move(json), std::move(root)};
+  }
 
-            auto parse_result_value = self(token_stream_span);
-            inner_json.emplace(
-                parse_result_key.first.GetStringView() | rng::to<std::string>(),
-                std::move(parse_result_value.first));
-            token_stream_span = parse_result_value.second;
-          } else {
-            throw std::runtime_error{fmt::format(
-                "Parser expectes string and colon for map key, token-stream: "
-                "{}",
-                token_stream_span)};
-          }
+  [[nodiscard]] constexpr auto Content() const noexcept -> std::string_view {
+    return m_content;
+  }
+
+  [[nodiscard]] constexpr auto GetJson() const noexcept -> Json const& {
+    return m_json;
+  }
+
+  /// @return range of the value at json pointer (RFC 6901), std::nullopt if
+  /// there is none
+  /// @throws std::invalid_argument for an invalid json pointer
+  [[nodiscard]] constexpr auto RangeOf(std::string_view json_pointer) const
+      -> std::optional<SourceRange> {
+    JsonPointerSegments segments{json_pointer};
+    auto const* json{&m_json};
+    auto const* node{&m_root};
+    auto begin{m_root.offset};
+    while (auto const next_segment{segments.Next()}) {
+      auto const segment{*next_segment};
+      std::size_t child_index{Json::json_object_t::kNpos};
+      if (json->IsType<Json::json_object_t>()) {
+        child_index = json->GetMap().IndexOf(segment);
+      } else if (json->IsType<Json::json_array_t>()) {
+        auto const* const end{rng::data(segment) + rng::size(segment)};
+        if (auto const [ptr, ec]{
+                std::from_chars(rng::data(segment), end, child_index)};
+            ec != std::errc{} or ptr != end) {
+          return std::nullopt;
         }
+      }
+      if (child_index >= rng::size(node->children)) {
+        return std::nullopt;
+      }
+      json = &ChildOf(*json, child_index);
+      node = &node->children[child_index];
+      begin += node->offset;
+    }
+    return SourceRange{begin, begin + node->size};
+  }
+
+  /// applies edit to the text and re-parses the smallest container whose
+  /// brackets enclose it. If that container no longer parses on its own,
+  /// e.g. because the edit moved one of its brackets, the enclosing
+  /// containers are tried in turn, up to the whole text. Ranges of the values
+  /// after the edit are shifted.
+  /// @return range of the re-parsed value in the new text
+  /// @throws std::out_of_range if edit exceeds the text
+  /// @throws std::invalid_argument/std::runtime_error if the edited text is
+  /// not valid json; the document is left unchanged then
+  constexpr auto Apply(TextEdit const& edit) -> SourceRange {
+    if (edit.offset > rng::size(m_content) or
+        edit.removed > rng::size(m_content) - edit.offset) {
+      throw std::out_of_range{"Text edit exceeds the json content."};
+    }
+    auto const growth{static_cast<std::ptrdiff_t>(rng::size(edit.inserted)) -
+                      static_cast<std::ptrdiff_t>(edit.removed)};
 
+    // containers enclosing the edit, outermost first, as path of child
+    // indices plus their begin
+    auto const encloses{[&edit](std::size_t begin, SourceNode const& node) {
+      return begin < edit.offset and
+             edit.offset + edit.removed < begin + node.size;
+    }};
+    std::vector<std::size_t> path{};
+    std::vector<std::size_t> begins{};
+    auto const* json{&m_json};
+    auto const* node{&m_root};
+    auto begin{m_root.offset};
+    while (IsContainer(*json) and encloses(begin, *node)) {
+      begins.push_back(begin);
+      auto const child{rng::find_if(node->children, [&](auto const& child) {
+        return encloses(begin + child.offset, child);
+      })};
+      if (child == rng::cend(node->children)) {
         break;
       }
+      auto const child_index{static_cast<std::size_t>(
+          rng::distance(rng::cbegin(node->children), child))};
+      path.push_back(child_index);
+      json = &ChildOf(*json, child_index);
+      node = &*child;
+      begin += child->offset;
+    }
+    path.resize(rng::size(begins) == 0 ? 0 : rng::size(begins) - 1);
 
-      case kLeftBracket: {
-        token_stream_span = token_stream_span.subspan(1);
+    // edits the text in place, keeping only the removed bytes to undo it
+    std::string const removed_text{
+        std::string_view{m_content}.substr(edit.offset, edit.removed)};
+    m_content.replace(edit.offset, edit.removed, edit.inserted);
 
-        Json::json_array_t inner_json{};
-        // TODO: reserve size ?
-        while (true) {
-          if (token_stream_span.front().type == kRightBracket) {
-            ret_json = Json{std::move(inner_json)};
-            break;
+    for (auto depth{rng::size(begins)}; depth != 0; --depth) {
+      auto const container_begin{begins[depth - 1]};
+      auto* target_node{&m_root};
+      for (auto const index : std::span{path}.first(depth - 1)) {
+        target_node = &target_node->children[index];
+      }
+      try {
+        auto [new_json, new_node]{Build(std::string_view{m_content}.substr(
+            container_begin, Grown(target_node->size, growth)))};
+        Splice(std::span{path}.first(depth - 1), std::move(new_json),
+               std::move(new_node.children), growth);
+        return SourceRange{container_begin,
+                           container_begin + target_node->size};
+      } catch (std::logic_error const&) {
+        // tries the enclosing container
+      } catch (std::runtime_error const&) {
+        // tries the enclosing container
+      }
+    }
+
+    try {
+      auto [json_value, root]{Build(m_content)};
+      m_json = std::move(json_value);
+      m_root = std::move(root);
+    } catch (...) {
+      m_content.replace(edit.offset, rng::size(edit.inserted), removed_text);
+      throw;
+    }
+    return SourceRange{m_root.offset, m_root.offset + m_root.size};
+  }
+
+ private:
+  constexpr EditableJson(std::string&& content, Json&& json,
+                         SourceNode&& root) noexcept
+      : m_content{std::move(content)},
+        m_json{std::move(json)},
+        m_root{std::move(root)} {}
+
+  /// @return the value of content and its range, relative to the begin of
+  /// content
+  /// @throws std::invalid_argument/std::runtime_error for malformed json
+  [[nodiscard]] static constexpr auto Build(std::string_view content)
+      -> std::pair<Json, SourceNode> {
+    TokenStream tokens{};
+    LexInto(content, tokens);
+
+    // string lexemes exclude their quotation marks
+    auto const offset_of{[&content](Token const& token) {
+      return static_cast<std::size_t>(rng::data(token.lexeme) -
+                                      rng::data(content));
+    }};
+    auto const quote_size{[](Token const& token) -> std::size_t {
+      return token.type == TokenType::kString ? 1 : 0;
+    }};
+
+    // ranges of the values parsed so far whose container is not complete
+    // yet; a container takes the ranges of its children off the top
+    std::vector<SourceNode> nodes{};
+    auto [json, rest]{ParseTokenPrefix(
+        tokens, {},
+        [&](std::span<Token const> value_tokens, std::size_t child_count) {
+          auto const& first{value_tokens.front()};
+          auto const& last{value_tokens.back()};
+          auto const begin{offset_of(first) - quote_size(first)};
+          SourceNode node{.offset = begin,
+                          .size = offset_of(last) + rng::size(last.lexeme) +
+                                  quote_size(last) - begin};
+          auto const children{std::span{nodes}.last(child_count)};
+          node.children.assign(std::make_move_iterator(rng::begin(children)),
+                               std::make_move_iterator(rng::end(children)));
+          for (auto& child : node.children) {
+            child.offset -= begin;
           }
+          nodes.resize(rng::size(nodes) - child_count);
+          nodes.push_back(std::move(node));
+        })};
+    if (not rng::empty(rest)) {
+      throw std::runtime_error{
+          fmt::format("Unexpected tokens after json value: {}", rest)};
+    }
+    return {std::move(json), std::move(nodes.back())};
+  }
 
-          auto [inner_json_element, advanced_subspan] = self(token_stream_span);
-          inner_json.push_back(std::move(inner_json_element));
-          token_stream_span = advanced_subspan;
-        }
+  [[nodiscard]] static constexpr auto IsContainer(Json const& json) noexcept
+      -> bool {
+    return json.IsType<Json::json_object_t>() or
+           json.IsType<Json::json_array_t>();
+  }
 
-        break;
-      }
+  template <class J>
+  [[nodiscard]] static constexpr auto ChildOf(J& json, std::size_t index)
+      -> J& {
+    if (json.template IsType<Json::json_object_t>()) {
+      auto& json_object{std::get<Json::json_object_t>(json.m_value)};
+      return json_object.at(rng::next(rng::begin(json_object),
+                                      static_cast<std::ptrdiff_t>(index))
+                                ->first);
+    }
+    return std::get<Json::json_array_t>(json.m_value)[index];
+  }
 
-      case kString: {
-        ret_json = Json{std::string{token_stream_span.front().lexeme}};
-        break;
-      }
+  /// @return value grown by growth bytes, which may be negative
+  [[nodiscard]] static constexpr auto Grown(std::size_t value,
+                                            std::ptrdiff_t growth) noexcept
+      -> std::size_t {
+    return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(value) +
+                                    growth);
+  }
 
-      case kTrue: {
-        ret_json = Json{true};
-        break;
+  /// replaces the container at path with json and the ranges of its
+  /// children, then grows it and its ancestors by growth bytes and shifts
+  /// their following siblings
+  constexpr auto Splice(std::span<std::size_t const> path, Json&& json,
+                        std::vector<SourceNode>&& children,
+                        std::ptrdiff_t growth) -> void {
+    auto* target_json{&m_json};
+    auto* target_node{&m_root};
+    for (auto const index : path) {
+      target_node->size = Grown(target_node->size, growth);
+      for (auto& sibling :
+           target_node->children | std::views::drop(index + 1)) {
+        sibling.offset = Grown(sibling.offset, growth);
       }
+      target_json = &ChildOf(*target_json, index);
+      target_node = &target_node->children[index];
+    }
+    target_node->size = Grown(target_node->size, growth);
+    target_node->children = std::move(children);
+    *target_json = std::move(json);
+  }
 
-      case kFalse: {
-        ret_json = Json{false};
-        break;
-      }
+  std::string m_content;
+  Json m_json;
+  SourceNode m_root;
+};
 
-      case kNull: {
-        ret_json = Json{std::monostate{}};
-        break;
-      }
+/// traversal of Visit()
+export enum class VisitMode : std::uint8_t {
+  /// spreads subtrees over a work-stealing thread pool. A container is
+  /// visited before its children, siblings in no particular order.
+  kParallel,
+  /// on the calling thread, a container before its children
+  kPreOrder,
+  /// on the calling thread, a container after its children
+  kPostOrder,
+};
 
-      case kNumber: {
-        double value;
-        auto const& token{token_stream_span.front()};
-
-        auto char_conv_result{std::from_chars(rng::begin(token.lexeme),
-                                              rng::end(token.lexeme), value)};
-        if (char_conv_result.ec != std::errc{} or
-            char_conv_result.ptr != rng::end(token.lexeme)) {
-          throw std::runtime_error(
-              fmt::format("Failed to convert into number the token lexeme: {}",
-                          token.lexeme));
-        }
-        ret_json = Json{value};
-        break;
-      }
+export struct VisitOptions {
+  VisitMode mode{VisitMode::kParallel};
+  /// threads of VisitMode::kParallel, 0 for one per hardware thread
+  std::size_t thread_count{0};
+  /// VisitMode::kParallel hands the children of containers with more
+  /// children than this to the pool, in ranges of at most this many
+  std::size_t split_size{256};
+};
 
-      default: {
-        throw std::logic_error{fmt::format("Unexpected token received: {}",
-                                           token_stream_span.front())};
+/// visitor of Visit(). Visit() is called for every value with its depth
+/// (0 for the root) and the state of the calling thread. Each thread starts
+/// with a value-initialized state_type; after the walk Merge() folds the
+/// states of all threads into one. Both are called on a const visitor, also
+/// concurrently.
+export template <class V>
+concept JsonVisitor =
+    std::default_initializable<typename V::state_type> and
+    std::movable<typename V::state_type> and
+    requires(V const& visitor, Json const& json, std::size_t depth,
+             typename V::state_type& state) {
+      visitor.Visit(json, depth, state);
+      visitor.Merge(state, std::move(state));
+    };
+
+[[nodiscard]] constexpr auto ChildCount(Json const& json) -> std::size_t {
+  if (json.IsType<Json::json_object_t>()) {
+    return rng::size(json.GetMap());
+  }
+  if (json.IsType<Json::json_array_t>()) {
+    return rng::size(json.GetArray());
+  }
+  return 0;
+}
+
+/// @pre index < ChildCount(json)
+[[nodiscard]] constexpr auto ChildAt(Json const& json, std::size_t index)
+    -> Json const& {
+  if (json.IsType<Json::json_object_t>()) {
+    return rng::next(rng::begin(json.GetMap()),
+                     static_cast<std::ptrdiff_t>(index))
+        ->second;
+  }
+  return json.GetArray()[index];
+}
+
+/// serial walk of VisitMode::kPreOrder/kPostOrder
+template <JsonVisitor V>
+constexpr auto VisitSerial(Json const& json, std::size_t depth,
+                           V const& visitor, VisitMode mode,
+                           typename V::state_type& state) -> void {
+  if (mode == VisitMode::kPreOrder) {
+    visitor.Visit(json, depth, state);
+  }
+  for (std::size_t index{0}, count{ChildCount(json)}; index < count;
+       ++index) {
+    VisitSerial(ChildAt(json, index), depth + 1, visitor, mode, state);
+  }
+  if (mode == VisitMode::kPostOrder) {
+    visitor.Visit(json, depth, state);
+  }
+}
+
+/// walk of VisitMode::kParallel. Each worker owns a deque of tasks; it takes
+/// the newest of its own tasks and steals the oldest, i.e. largest, ones of
+/// the others when it runs dry. Large containers are split into ranges of
+/// children, which are halved again when a worker picks them up.
+template <JsonVisitor V>
+class ParallelVisit final {
+ public:
+  using state_type = V::state_type;
+
+  ParallelVisit(V const& visitor, std::size_t thread_count,
+                std::size_t split_size)
+      : m_visitor{visitor},
+        m_split_size{std::max(split_size, std::size_t{1})},
+        m_queues(thread_count),
+        m_states(thread_count) {}
+
+  /// @throws what the visitor throws, the first of them if several threads
+  /// fail
+  [[nodiscard]] auto Run(Json const& json) -> state_type {
+    Push(0, Task{.json = &json});
+    {
+      std::vector<std::jthread> threads{};
+      for (std::size_t worker{1}; worker < rng::size(m_queues); ++worker) {
+        threads.emplace_back([this, worker] { Work(worker); });
       }
+      Work(0);
     }
-
-    token_stream_span = token_stream_span.subspan(1);
-    if (rng::size(token_stream_span) == 0) {
-      return {std::move(ret_json), token_stream_span};
+    if (m_error) {
+      std::rethrow_exception(m_error);
     }
 
-    auto const token_type{token_stream_span.front().type};
-    if (not(token_type == kComma or token_type == kColon or
-            token_type == kRightBrace or token_type == kRightBracket)) {
-      throw std::runtime_error(fmt::format(
-          "Parser expecting `,:}}]`, but token-stream: {}", token_stream_span));
+    auto state{std::move(m_states.front().state)};
+    for (auto& worker_state : m_states | std::views::drop(1)) {
+      m_visitor.Merge(state, std::move(worker_state.state));
     }
+    return state;
+  }
 
-    if (token_type == kComma) {
-      token_stream_span = token_stream_span.subspan(1);
+ private:
+  /// children [begin, end) of json at depth, or json itself if begin == end
+  struct Task {
+    Json const* json{nullptr};
+    std::size_t depth{0};
+    std::size_t begin{0};
+    std::size_t end{0};
+  };
 
-      if (token_stream_span.front().type == kRightBrace or
-          token_stream_span.front().type == kRightBracket) {
-        throw std::runtime_error(
-            fmt::format("Parser not expecting }}], but token-stream: {}",
-                        token_stream_span));
+  struct WorkQueue {
+    std::mutex mutex{};
+    std::deque<Task> tasks{};
+  };
+
+  /// state of a worker on cache lines of its own, as small states updated
+  /// for every value would otherwise share them with other workers
+  struct alignas(std::hardware_destructive_interference_size) WorkerState {
+    state_type state{};
+  };
+
+  auto Push(std::size_t worker, Task const& task) -> void {
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    std::scoped_lock const lock{m_queues[worker].mutex};
+    m_queues[worker].tasks.push_back(task);
+  }
+
+  [[nodiscard]] auto Pop(std::size_t worker) -> std::optional<Task> {
+    {
+      auto& queue{m_queues[worker]};
+      std::scoped_lock const lock{queue.mutex};
+      if (not rng::empty(queue.tasks)) {
+        auto const task{queue.tasks.back()};
+        queue.tasks.pop_back();
+        return task;
+      }
+    }
+    for (std::size_t offset{1}; offset < rng::size(m_queues); ++offset) {
+      auto& queue{m_queues[(worker + offset) % rng::size(m_queues)]};
+      std::scoped_lock const lock{queue.mutex};
+      if (not rng::empty(queue.tasks)) {
+        auto const task{queue.tasks.front()};
+        queue.tasks.pop_front();
+        return task;
       }
     }
+    return std::nullopt;
+  }
 
-    return {std::move(ret_json), token_stream_span};
-  }};
+  auto Work(std::size_t worker) -> void {
+    while (m_pending.load(std::memory_order_acquire) != 0 and
+           not m_failed.load(std::memory_order_relaxed)) {
+      auto const task{Pop(worker)};
+      if (not task) {
+        std::this_thread::yield();
+        continue;
+      }
+      try {
+        Execute(worker, *task);
+      } catch (...) {
+        std::scoped_lock const lock{m_error_mutex};
+        if (not m_error) {
+          m_error = std::current_exception();
+        }
+        m_failed.store(true, std::memory_order_relaxed);
+      }
+      m_pending.fetch_sub(1, std::memory_order_release);
+    }
+  }
 
-  return parse(std::get<TokenStream>(token_stream_with_buffer)).first;
-}
+  auto Execute(std::size_t worker, Task task) -> void {
+    if (task.begin == task.end) {
+      Walk(worker, *task.json, task.depth);
+      return;
+    }
+    // leaves the upper halves to thieves
+    while (task.end - task.begin > m_split_size) {
+      auto const middle{task.begin + (task.end - task.begin) / 2};
+      Push(worker, Task{.json = task.json,
+                        .depth = task.depth,
+                        .begin = middle,
+                        .end = task.end});
+      task.end = middle;
+    }
+    for (auto index{task.begin}; index < task.end; ++index) {
+      Walk(worker, ChildAt(*task.json, index), task.depth);
+    }
+  }
 
-export [[nodiscard]] constexpr auto Parse(
-    std::filesystem::path&& absolute_file_path) -> Json {
-  return std::optional{ReadFile(std::move(absolute_file_path))}
-      .transform(Lex)
-      .transform(ParseTokens)
-      .value();
-}
+  auto Walk(std::size_t worker, Json const& json, std::size_t depth)
+      -> void {
+    m_visitor.Visit(json, depth, m_states[worker].state);
+    if (auto const count{ChildCount(json)}; count > m_split_size) {
+      Push(worker,
+           Task{.json = &json, .depth = depth + 1, .begin = 0, .end = count});
+    } else {
+      for (std::size_t index{0}; index < count; ++index) {
+        Walk(worker, ChildAt(json, index), depth + 1);
+      }
+    }
+  }
 
-export [[nodiscard]] constexpr auto Parse(std::string_view json_content)
-    -> Json {
-  return std::optional{std::make_shared<std::string const>(json_content)}
-      .transform(Lex)
-      .transform(ParseTokens)
-      .value();
+  V const& m_visitor;
+  std::size_t m_split_size;
+  std::vector<WorkQueue> m_queues;
+  std::vector<WorkerState> m_states;
+  /// pushed tasks not finished yet
+  std::atomic<std::size_t> m_pending{0};
+  std::atomic<bool> m_failed{false};
+  std::mutex m_error_mutex{};
+  std::exception_ptr m_error{};
+};
+
+/// walks json with visitor, serially or on a work-stealing thread pool
+/// (see VisitMode), and returns the merged state of all threads.
+///
+/// ```cpp
+/// struct CountNumbers {
+///   using state_type = std::size_t;
+///   auto Visit(Json const& json, std::size_t, std::size_t& count) const {
+///     count += json.IsType<double>() ? 1 : 0;
+///   }
+///   auto Merge(std::size_t& count, std::size_t&& other) const {
+///     count += other;
+///   }
+/// };
+/// auto const numbers{uzleo::json::Visit(json, CountNumbers{})};
+/// ```
+/// @throws what visitor throws. The walk stops early then.
+export template <JsonVisitor V>
+auto Visit(Json const& json, V const& visitor, VisitOptions const& options = {})
+    -> V::state_type {
+  auto const thread_count{
+      options.thread_count != 0
+          ? options.thread_count
+          : std::max(std::size_t{1},
+                     std::size_t{std::thread::hardware_concurrency()})};
+  if (options.mode != VisitMode::kParallel or thread_count == 1) {
+    typename V::state_type state{};
+    VisitSerial(json, 0, visitor,
+                options.mode == VisitMode::kPostOrder ? VisitMode::kPostOrder
+                                                      : VisitMode::kPreOrder,
+                state);
+    return state;
+  }
+  return ParallelVisit<V>{visitor, thread_count, options.split_size}.Run(json);
 }
 
 }  // namespace uzleo::json
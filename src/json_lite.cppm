@@ -0,0 +1,664 @@
+
+// SPDX-License-Identifier: MIT
+
+module;
+
+// no `import std;` and no fmt: this module is built with -fno-exceptions
+// -fno-rtti for devices and only pulls in the few headers it needs.
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <system_error>
+
+export module uzleo.json.lite;
+
+/// low-footprint json parser for devices with tight flash/RAM budgets. Errors
+/// are reported as Errc values instead of exceptions, all storage is a
+/// fixed-capacity array inside the Document (no heap), strings view into the
+/// parsed text and numbers are converted with std::from_chars on access.
+namespace uzleo::json::lite {
+
+export enum class Errc : std::uint8_t {
+  kOk,
+  kUnexpectedEnd,
+  kUnexpectedCharacter,
+  kInvalidLiteral,
+  kInvalidNumber,
+  kInvalidString,
+  /// more nested containers than kMaxDepth of the Document
+  kTooDeep,
+  /// more values than kMaxNodes of the Document
+  kOutOfNodes,
+  /// text or string larger than a Node can address
+  kTooLarge,
+  /// Writer buffer exhausted
+  kBufferFull,
+};
+
+export [[nodiscard]] constexpr auto ErrcName(Errc errc) noexcept
+    -> std::string_view {
+  switch (errc) {
+    case Errc::kOk: {
+      return "ok";
+    }
+    case Errc::kUnexpectedEnd: {
+      return "unexpected end";
+    }
+    case Errc::kUnexpectedCharacter: {
+      return "unexpected character";
+    }
+    case Errc::kInvalidLiteral: {
+      return "invalid literal";
+    }
+    case Errc::kInvalidNumber: {
+      return "invalid number";
+    }
+    case Errc::kInvalidString: {
+      return "invalid string";
+    }
+    case Errc::kTooDeep: {
+      return "too deep";
+    }
+    case Errc::kOutOfNodes: {
+      return "out of nodes";
+    }
+    case Errc::kTooLarge: {
+      return "too large";
+    }
+    case Errc::kBufferFull: {
+      return "buffer full";
+    }
+  }
+  return "unknown";
+}
+
+export enum class Kind : std::uint8_t {
+  kNull,
+  kFalse,
+  kTrue,
+  kNumber,
+  kString,
+  kArray,
+  kObject,
+};
+
+/// one value of a parsed document in 12 bytes. Values are stored in document
+/// order; an object member is its key (a kString node) followed by its value.
+class Node final {
+ public:
+  static constexpr std::uint32_t kLengthBits{28};
+  static constexpr std::uint32_t kMaxLength{(std::uint32_t{1} << kLengthBits) -
+                                            1};
+
+  constexpr Node() = default;
+  constexpr Node(Kind kind, std::uint32_t offset, std::uint32_t length) noexcept
+      : m_offset{offset},
+        m_kind_length{(static_cast<std::uint32_t>(kind) << kLengthBits) |
+                      length},
+        m_end{0} {}
+
+  [[nodiscard]] constexpr auto GetKind() const noexcept -> Kind {
+    return static_cast<Kind>(m_kind_length >> kLengthBits);
+  }
+
+  /// text offset of scalars, strings without their quotes
+  [[nodiscard]] constexpr auto Offset() const noexcept -> std::uint32_t {
+    return m_offset;
+  }
+
+  /// text length of scalars, member/element count of containers
+  [[nodiscard]] constexpr auto Length() const noexcept -> std::uint32_t {
+    return m_kind_length & kMaxLength;
+  }
+
+  constexpr auto SetLength(std::uint32_t length) noexcept -> void {
+    m_kind_length = (m_kind_length & ~kMaxLength) | length;
+  }
+
+  /// index after the last node of the subtree
+  [[nodiscard]] constexpr auto End() const noexcept -> std::uint32_t {
+    return m_end;
+  }
+
+  constexpr auto SetEnd(std::uint32_t end) noexcept -> void { m_end = end; }
+
+ private:
+  std::uint32_t m_offset{0};
+  std::uint32_t m_kind_length{0};
+  std::uint32_t m_end{0};
+};
+
+static_assert(sizeof(Node) == 12);
+
+/// read-only handle of a value in a Document. A failed lookup yields an
+/// invalid Value, on which every accessor returns std::nullopt/0/invalid.
+export class Value final {
+ public:
+  constexpr Value() = default;
+  constexpr Value(std::span<Node const> nodes, std::string_view text,
+                  std::uint32_t index) noexcept
+      : m_nodes{nodes}, m_text{text}, m_index{index} {}
+
+  [[nodiscard]] constexpr auto IsValid() const noexcept -> bool {
+    return m_index < m_nodes.size();
+  }
+
+  [[nodiscard]] constexpr auto GetKind() const noexcept -> std::optional<Kind> {
+    if (not IsValid()) {
+      return std::nullopt;
+    }
+    return m_nodes[m_index].GetKind();
+  }
+
+  [[nodiscard]] constexpr auto IsNull() const noexcept -> bool {
+    return GetKind() == Kind::kNull;
+  }
+
+  [[nodiscard]] constexpr auto GetBool() const noexcept -> std::optional<bool> {
+    if (auto const kind{GetKind()};
+        kind == Kind::kTrue or kind == Kind::kFalse) {
+      return kind == Kind::kTrue;
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] auto GetDouble() const noexcept -> std::optional<double> {
+    if (GetKind() != Kind::kNumber) {
+      return std::nullopt;
+    }
+    auto const lexeme{Text()};
+    double value{0.0};
+    std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), value);
+    return value;
+  }
+
+  /// @return string as written, i.e. still escaped
+  [[nodiscard]] constexpr auto GetStringView() const noexcept
+      -> std::optional<std::string_view> {
+    if (GetKind() != Kind::kString) {
+      return std::nullopt;
+    }
+    return Text();
+  }
+
+  /// @return member/element count, 0 for scalars
+  [[nodiscard]] constexpr auto Size() const noexcept -> std::size_t {
+    if (auto const kind{GetKind()};
+        kind == Kind::kArray or kind == Kind::kObject) {
+      return m_nodes[m_index].Length();
+    }
+    return 0;
+  }
+
+  /// @return element at index of an array
+  [[nodiscard]] constexpr auto At(std::size_t index) const noexcept -> Value {
+    if (GetKind() != Kind::kArray or index >= Size()) {
+      return Value{};
+    }
+    auto child{m_index + 1};
+    for (; index != 0; --index) {
+      child = m_nodes[child].End();
+    }
+    return Value{m_nodes, m_text, child};
+  }
+
+  /// @return value of member key of an object, compared as written
+  [[nodiscard]] constexpr auto GetJson(std::string_view key) const noexcept
+      -> Value {
+    if (GetKind() != Kind::kObject) {
+      return Value{};
+    }
+    auto child{m_index + 1};
+    for (std::size_t member{0}; member < Size(); ++member) {
+      if (Value{m_nodes, m_text, child}.Text() == key) {
+        return Value{m_nodes, m_text, child + 1};
+      }
+      child = m_nodes[child + 1].End();
+    }
+    return Value{};
+  }
+
+  [[nodiscard]] constexpr auto Contains(std::string_view key) const noexcept
+      -> bool {
+    return GetJson(key).IsValid();
+  }
+
+ private:
+  [[nodiscard]] constexpr auto Text() const noexcept -> std::string_view {
+    auto const& node{m_nodes[m_index]};
+    return m_text.substr(node.Offset(), node.Length());
+  }
+
+  std::span<Node const> m_nodes{};
+  std::string_view m_text{};
+  std::uint32_t m_index{0};
+};
+
+/// a parsed document of at most kMaxNodes values (object keys count as
+/// values) nested at most kMaxDepth deep. All storage is inline, so a
+/// Document is meant to live in static storage or on a large enough stack:
+/// its size is about 12 * kMaxNodes + 4 * kMaxDepth bytes. The parsed text
+/// is viewed, not copied, and must outlive the Document.
+///
+/// ```cpp
+/// static uzleo::json::lite::Document<64> document{};
+/// if (document.Parse(text) != uzleo::json::lite::Errc::kOk) { ... }
+/// auto const interval{document.Root().GetJson("settings")
+///                         .GetJson("refresh_interval").GetDouble()};
+/// ```
+export template <std::size_t kMaxNodes, std::size_t kMaxDepth = 16>
+class Document final {
+ public:
+  static_assert(kMaxNodes > 0 and kMaxNodes <= Node::kMaxLength);
+  static_assert(kMaxDepth > 0);
+
+  /// parses text, replacing the previous document. On failure the document
+  /// is empty and ErrorOffset() tells where parsing stopped.
+  constexpr auto Parse(std::string_view text) noexcept -> Errc {
+    m_text = text;
+    m_size = 0;
+    m_error_offset = 0;
+    auto const errc{ParseText()};
+    if (errc != Errc::kOk) {
+      m_size = 0;
+    }
+    return errc;
+  }
+
+  /// @return the root, invalid if no document was parsed
+  [[nodiscard]] constexpr auto Root() const noexcept -> Value {
+    return Value{Nodes(), m_text, 0};
+  }
+
+  /// @return number of nodes in use, the high-water mark of the storage
+  [[nodiscard]] constexpr auto NodeCount() const noexcept -> std::size_t {
+    return m_size;
+  }
+
+  [[nodiscard]] constexpr auto ErrorOffset() const noexcept -> std::size_t {
+    return m_error_offset;
+  }
+
+ private:
+  enum class Expect : std::uint8_t {
+    kValue,
+    /// value or `]`
+    kFirstElement,
+    kKey,
+    /// key or `}`
+    kFirstKey,
+    kColon,
+    /// `,` or the bracket closing the innermost container
+    kSeparator,
+    kEnd,
+  };
+
+  [[nodiscard]] constexpr auto Nodes() const noexcept -> std::span<Node const> {
+    return std::span{m_nodes}.first(m_size);
+  }
+
+  /// appends a node, counted as child of the innermost open container
+  constexpr auto Add(Kind kind, std::size_t offset, std::size_t length,
+                     std::size_t depth) noexcept -> Errc {
+    if (m_size == kMaxNodes) {
+      return Errc::kOutOfNodes;
+    }
+    if (length > Node::kMaxLength) {
+      return Errc::kTooLarge;
+    }
+    if (depth != 0) {
+      auto& parent{m_nodes[m_open[depth - 1]]};
+      parent.SetLength(parent.Length() + 1);
+    }
+    m_nodes[m_size] = Node{kind, static_cast<std::uint32_t>(offset),
+                           static_cast<std::uint32_t>(length)};
+    ++m_size;
+    m_nodes[m_size - 1].SetEnd(static_cast<std::uint32_t>(m_size));
+    return Errc::kOk;
+  }
+
+  [[nodiscard]] constexpr auto StringEnd(std::size_t position) const noexcept
+      -> std::optional<std::size_t> {
+    for (++position; position < m_text.size(); ++position) {
+      if (m_text[position] == '\\') {
+        ++position;
+      } else if (m_text[position] == '"') {
+        return position;
+      } else if (static_cast<unsigned char>(m_text[position]) < 0x20) {
+        return std::nullopt;
+      }
+    }
+    return std::nullopt;
+  }
+
+  /// @return size of the json number at the begin of number: an optional
+  /// minus, an integer part without leading zeros, optional fraction and
+  /// exponent. 0 if there is none.
+  [[nodiscard]] static constexpr auto NumberSize(
+      std::string_view number) noexcept -> std::size_t {
+    std::size_t size{0};
+    auto const skip{[&](std::string_view characters) {
+      if (size < number.size() and characters.contains(number[size])) {
+        ++size;
+        return true;
+      }
+      return false;
+    }};
+    auto const skip_digits{[&] {
+      auto const begin{size};
+      while (skip("0123456789")) {
+      }
+      return size != begin;
+    }};
+
+    skip("-");
+    if (not skip("0") and not skip_digits()) {
+      return 0;
+    }
+    if (skip(".") and not skip_digits()) {
+      return 0;
+    }
+    if (skip("eE")) {
+      skip("+-");
+      if (not skip_digits()) {
+        return 0;
+      }
+    }
+    return size;
+  }
+
+  [[nodiscard]] constexpr auto ParseText() noexcept -> Errc {
+    if constexpr (sizeof(std::size_t) > sizeof(std::uint32_t)) {
+      if (m_text.size() > std::uint32_t{0xffffffff}) {
+        return Errc::kTooLarge;
+      }
+    }
+
+    static constexpr auto is_whitespace{[](char value) noexcept {
+      return value == ' ' or value == '\n' or value == '\r' or value == '\t';
+    }};
+    static constexpr auto in_number{[](char value) noexcept {
+      return (value >= '0' and value <= '9') or value == '-' or
+             value == '+' or value == '.' or value == 'e' or value == 'E';
+    }};
+
+    std::size_t depth{0};
+    auto expect{Expect::kValue};
+    std::size_t& position{m_error_offset};
+    // a key is added with depth, counting as the member of its object, so
+    // values inside objects are added with depth 0 to not count them again
+    auto const value_depth{[&] {
+      return depth != 0 and
+                     m_nodes[m_open[depth - 1]].GetKind() == Kind::kObject
+                 ? 0
+                 : depth;
+    }};
+    auto const after_value{[&] {
+      expect = depth == 0 ? Expect::kEnd : Expect::kSeparator;
+    }};
+
+    for (; position < m_text.size(); ++position) {
+      auto const value{m_text[position]};
+      if (is_whitespace(value)) {
+        continue;
+      }
+
+      switch (expect) {
+        case Expect::kEnd: {
+          return Errc::kUnexpectedCharacter;
+        }
+        case Expect::kColon: {
+          if (value != ':') {
+            return Errc::kUnexpectedCharacter;
+          }
+          expect = Expect::kValue;
+          break;
+        }
+        case Expect::kSeparator: {
+          auto const open_kind{m_nodes[m_open[depth - 1]].GetKind()};
+          if (value == ',') {
+            expect = open_kind == Kind::kObject ? Expect::kKey : Expect::kValue;
+            break;
+          }
+          if (value != (open_kind == Kind::kObject ? '}' : ']')) {
+            return Errc::kUnexpectedCharacter;
+          }
+          m_nodes[m_open[--depth]].SetEnd(static_cast<std::uint32_t>(m_size));
+          after_value();
+          break;
+        }
+        case Expect::kFirstKey:
+        case Expect::kKey: {
+          if (value == '}' and expect == Expect::kFirstKey) {
+            m_nodes[m_open[--depth]].SetEnd(
+                static_cast<std::uint32_t>(m_size));
+            after_value();
+            break;
+          }
+          if (value != '"') {
+            return Errc::kUnexpectedCharacter;
+          }
+          auto const end{StringEnd(position)};
+          if (not end) {
+            return Errc::kInvalidString;
+          }
+          if (auto const errc{Add(Kind::kString, position + 1,
+                                  *end - position - 1, depth)};
+              errc != Errc::kOk) {
+            return errc;
+          }
+          position = *end;
+          expect = Expect::kColon;
+          break;
+        }
+        case Expect::kFirstElement:
+        case Expect::kValue: {
+          if (value == ']' and expect == Expect::kFirstElement) {
+            m_nodes[m_open[--depth]].SetEnd(
+                static_cast<std::uint32_t>(m_size));
+            after_value();
+            break;
+          }
+          if (value == '{' or value == '[') {
+            if (depth == kMaxDepth) {
+              return Errc::kTooDeep;
+            }
+            auto const kind{value == '{' ? Kind::kObject : Kind::kArray};
+            if (auto const errc{Add(kind, position, 0, value_depth())};
+                errc != Errc::kOk) {
+              return errc;
+            }
+            m_open[depth++] = static_cast<std::uint32_t>(m_size - 1);
+            expect = kind == Kind::kObject ? Expect::kFirstKey
+                                           : Expect::kFirstElement;
+            break;
+          }
+
+          auto kind{Kind::kNumber};
+          auto length{std::size_t{0}};
+          auto const rest{m_text.substr(position)};
+          if (value == '"') {
+            auto const end{StringEnd(position)};
+            if (not end) {
+              return Errc::kInvalidString;
+            }
+            kind = Kind::kString;
+            ++position;
+            length = *end - position;
+          } else if (value == 't' or value == 'f' or value == 'n') {
+            static constexpr std::array<std::string_view, 3> kLiterals{
+                "null", "false", "true"};
+            kind = value == 't'   ? Kind::kTrue
+                   : value == 'f' ? Kind::kFalse
+                                  : Kind::kNull;
+            auto const literal{kLiterals[static_cast<std::size_t>(kind)]};
+            if (not rest.starts_with(literal)) {
+              return Errc::kInvalidLiteral;
+            }
+            length = literal.size();
+          } else if (in_number(value)) {
+            while (length < rest.size() and in_number(rest[length])) {
+              ++length;
+            }
+            // std::from_chars alone would accept 01, .5 or 1.
+            double number{0.0};
+            if (auto const [end, ec]{std::from_chars(
+                    rest.data(), rest.data() + length, number)};
+                NumberSize(rest.substr(0, length)) != length or
+                ec != std::errc{} or end != rest.data() + length) {
+              return Errc::kInvalidNumber;
+            }
+          } else {
+            return Errc::kUnexpectedCharacter;
+          }
+
+          if (auto const errc{Add(kind, position, length, value_depth())};
+              errc != Errc::kOk) {
+            return errc;
+          }
+          // strings also skip their closing quote
+          position += length - (kind == Kind::kString ? 0 : 1);
+          after_value();
+          break;
+        }
+      }
+    }
+    return expect == Expect::kEnd ? Errc::kOk : Errc::kUnexpectedEnd;
+  }
+
+  std::array<Node, kMaxNodes> m_nodes{};
+  /// indices of the open containers
+  std::array<std::uint32_t, kMaxDepth> m_open{};
+  std::string_view m_text{};
+  std::size_t m_size{0};
+  std::size_t m_error_offset{0};
+};
+
+/// writes compact json into a caller-provided buffer, formatting numbers
+/// with std::to_chars. Commas and colons are inserted automatically; string
+/// values and keys are written as given, i.e. must already be escaped. After
+/// the first error every call is a no-op and Error() reports it.
+///
+/// ```cpp
+/// std::array<char, 256> buffer{};
+/// uzleo::json::lite::Writer writer{buffer};
+/// writer.BeginObject();
+/// writer.Key("temperature");
+/// writer.Number(21.5);
+/// writer.EndObject();
+/// send(writer.View());
+/// ```
+export class Writer final {
+ public:
+  explicit constexpr Writer(std::span<char> buffer) noexcept
+      : m_buffer{buffer} {}
+
+  constexpr auto BeginObject() noexcept -> void { Open('{'); }
+  constexpr auto EndObject() noexcept -> void { Close('}'); }
+  constexpr auto BeginArray() noexcept -> void { Open('['); }
+  constexpr auto EndArray() noexcept -> void { Close(']'); }
+
+  constexpr auto Key(std::string_view key) noexcept -> void {
+    String(key);
+    Put(":");
+    m_needs_comma = false;
+  }
+
+  constexpr auto String(std::string_view value) noexcept -> void {
+    Separate();
+    Put("\"");
+    Put(value);
+    Put("\"");
+    m_needs_comma = true;
+  }
+
+  /// writes the shortest representation that round-trips. Non-finite
+  /// numbers have none in json and fail with Errc::kInvalidNumber.
+  auto Number(double value) noexcept -> void {
+    if (not std::isfinite(value)) {
+      Fail(Errc::kInvalidNumber);
+      return;
+    }
+    Separate();
+    if (m_errc != Errc::kOk) {
+      return;
+    }
+    auto const available{m_buffer.subspan(m_size)};
+    auto const [end, ec]{std::to_chars(
+        available.data(), available.data() + available.size(), value)};
+    if (ec != std::errc{}) {
+      Fail(Errc::kBufferFull);
+      return;
+    }
+    m_size += static_cast<std::size_t>(end - available.data());
+    m_needs_comma = true;
+  }
+
+  constexpr auto Bool(bool value) noexcept -> void {
+    Separate();
+    Put(value ? "true" : "false");
+    m_needs_comma = true;
+  }
+
+  constexpr auto Null() noexcept -> void {
+    Separate();
+    Put("null");
+    m_needs_comma = true;
+  }
+
+  /// @return the json written so far
+  [[nodiscard]] constexpr auto View() const noexcept -> std::string_view {
+    return std::string_view{m_buffer.data(), m_size};
+  }
+
+  [[nodiscard]] constexpr auto Error() const noexcept -> Errc { return m_errc; }
+
+ private:
+  constexpr auto Fail(Errc errc) noexcept -> void {
+    if (m_errc == Errc::kOk) {
+      m_errc = errc;
+    }
+  }
+
+  constexpr auto Put(std::string_view text) noexcept -> void {
+    if (m_errc != Errc::kOk) {
+      return;
+    }
+    if (text.size() > m_buffer.size() - m_size) {
+      Fail(Errc::kBufferFull);
+      return;
+    }
+    for (auto const value : text) {
+      m_buffer[m_size++] = value;
+    }
+  }
+
+  constexpr auto Separate() noexcept -> void {
+    if (m_needs_comma) {
+      Put(",");
+    }
+  }
+
+  constexpr auto Open(char bracket) noexcept -> void {
+    Separate();
+    Put(std::string_view{&bracket, 1});
+    m_needs_comma = false;
+  }
+
+  constexpr auto Close(char bracket) noexcept -> void {
+    Put(std::string_view{&bracket, 1});
+    m_needs_comma = true;
+  }
+
+  std::span<char> m_buffer;
+  std::size_t m_size{0};
+  bool m_needs_comma{false};
+  Errc m_errc{Errc::kOk};
+};
+
+}  // namespace uzleo::json::lite
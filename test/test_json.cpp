@@ -1212,6 +1212,1399 @@ void OperatorSquareBracketApiTestCases() {
   TestOperatorSquareBracket_NonObjectNull();
 }
 
+
+auto TestObjectMap_LargeObjectLookup() {
+  fmt::println("Testing ObjectMap - Large object lookup ...");
+  std::string json = "{";
+  for (int i = 0; i < 5000; ++i) {
+    json += fmt::format("{}\"device-{}\": {}", i == 0 ? "" : ", ", i, i);
+  }
+  json += "}";
+
+  auto obj = uzleo::json::Parse(std::string_view{json});
+
+  if (obj.GetMap().size() != 5000) {
+    throw std::runtime_error("Test failed: object size should be 5000.");
+  }
+  for (int i = 0; i < 5000; ++i) {
+    if (obj.GetJson(fmt::format("device-{}", i)).GetDouble() != i) {
+      throw std::runtime_error(
+          fmt::format("Test failed: wrong value for 'device-{}'.", i));
+    }
+  }
+  if (obj.Contains("device-5000")) {
+    throw std::runtime_error("Test failed: 'device-5000' should not exist.");
+  }
+}
+
+auto TestObjectMap_EmplaceAndErase() {
+  fmt::println("Testing ObjectMap - Emplace and erase ...");
+  uzleo::json::Json::json_object_t obj{};
+  for (int i = 0; i < 100; ++i) {
+    obj.emplace(fmt::format("key{}", i), uzleo::json::Json{double(i)});
+  }
+  if (obj.emplace("key1", uzleo::json::Json{true}).second) {
+    throw std::runtime_error("Test failed: duplicate key was inserted.");
+  }
+  for (int i = 0; i < 100; i += 2) {
+    if (obj.erase(fmt::format("key{}", i)) != 1) {
+      throw std::runtime_error("Test failed: erase should remove the key.");
+    }
+  }
+
+  if (obj.size() != 50) {
+    throw std::runtime_error("Test failed: object size should be 50.");
+  }
+  for (int i = 0; i < 100; ++i) {
+    auto const key = fmt::format("key{}", i);
+    if (obj.contains(key) != (i % 2 == 1)) {
+      throw std::runtime_error(fmt::format("Test failed: wrong '{}'.", key));
+    }
+    if (i % 2 == 1 and obj.at(key).GetDouble() != i) {
+      throw std::runtime_error(fmt::format("Test failed: wrong '{}'.", key));
+    }
+  }
+}
+
+void ObjectMapTestCases() {
+  TestObjectMap_LargeObjectLookup();
+  TestObjectMap_EmplaceAndErase();
+}
+
+auto TestSortedKeys_DeterministicDump() {
+  fmt::println("Testing SortedKeys - Deterministic dump ...");
+  auto const json = uzleo::json::Parse(
+      std::string_view{R"({"c": 3, "a": {"z": true, "b": null}, "b": [2]})"},
+      {.sorted_keys = true});
+
+  if (json.Dump() != R"({"a": {"b": null, "z": true}, "b": [2], "c": 3})") {
+    throw std::runtime_error(
+        fmt::format("Test failed: unexpected Dump(): {}", json.Dump()));
+  }
+  if (not json.GetMap().IsSorted() or json.GetJson("c").GetDouble() != 3) {
+    throw std::runtime_error("Test failed: 'c' should be found.");
+  }
+  if (json.Contains("d")) {
+    throw std::runtime_error("Test failed: 'd' should not exist.");
+  }
+}
+
+auto TestSortedKeys_Equality() {
+  fmt::println("Testing SortedKeys - Equality ...");
+  std::string_view const content{R"({"x": [1, {"y": "z"}], "a": false})"};
+  std::string_view const reordered{R"({"a": false, "x": [1, {"y": "z"}]})"};
+
+  auto const sorted = uzleo::json::Parse(content, {.sorted_keys = true});
+  if (not(sorted == uzleo::json::Parse(reordered, {.sorted_keys = true})) or
+      not(sorted == uzleo::json::Parse(reordered))) {
+    throw std::runtime_error("Test failed: documents should be equal.");
+  }
+  if (sorted == uzleo::json::Parse(std::string_view{R"({"a": false})"})) {
+    throw std::runtime_error("Test failed: documents should differ.");
+  }
+}
+
+auto TestSortedKeys_Diff() {
+  fmt::println("Testing SortedKeys - Diff ...");
+  using enum uzleo::json::DiffEntry::Kind;
+
+  for (auto const sorted_keys : {true, false}) {
+    auto const lhs = uzleo::json::Parse(
+        std::string_view{R"({"a": 1, "b": {"c": [1, 2]}, "d/e": true})"},
+        {.sorted_keys = sorted_keys});
+    auto const rhs = uzleo::json::Parse(
+        std::string_view{R"({"b": {"c": [1, 3, 4]}, "d/e": true, "f": 0})"},
+        {.sorted_keys = sorted_keys});
+
+    auto diff = uzleo::json::Diff(lhs, rhs);
+    std::ranges::sort(diff, {}, &uzleo::json::DiffEntry::path);
+    std::vector<std::pair<uzleo::json::DiffEntry::Kind, std::string>> const
+        expected{
+            {kRemoved, "/a"}, {kChanged, "/b/c/1"}, {kAdded, "/b/c/2"},
+            {kAdded, "/f"}};
+    if (not std::ranges::equal(diff, expected, [](auto const& lhs_entry,
+                                                   auto const& rhs_entry) {
+          return lhs_entry.kind == rhs_entry.first and
+                 lhs_entry.path == rhs_entry.second;
+        })) {
+      throw std::runtime_error("Test failed: unexpected diff.");
+    }
+  }
+}
+
+auto TestSortedKeys_Merge() {
+  fmt::println("Testing SortedKeys - Merge ...");
+  for (auto const sorted_keys : {true, false}) {
+    auto merged = uzleo::json::Merge(
+        uzleo::json::Parse(
+            std::string_view{R"({"log": {"level": "info", "file": "a"}})"},
+            {.sorted_keys = sorted_keys}),
+        uzleo::json::Parse(
+            std::string_view{R"({"log": {"level": "debug"}, "port": 80})"},
+            {.sorted_keys = sorted_keys}));
+
+    auto const expected = uzleo::json::Parse(std::string_view{
+        R"({"log": {"file": "a", "level": "debug"}, "port": 80})"});
+    if (not(merged == expected)) {
+      throw std::runtime_error(
+          fmt::format("Test failed: unexpected merge: {}", merged.Dump()));
+    }
+  }
+}
+
+void SortedKeysTestCases() {
+  TestSortedKeys_DeterministicDump();
+  TestSortedKeys_Equality();
+  TestSortedKeys_Diff();
+  TestSortedKeys_Merge();
+}
+
+auto TestKey_Lookup() {
+  fmt::println("Testing Key - Lookup ...");
+  static constexpr uzleo::json::Key kValue{"value"};
+  static constexpr uzleo::json::Key kMissing{"missing"};
+
+  for (auto const member_count : {2, 50}) {
+    std::string json = R"({"value": 42)";
+    for (int i = 0; i < member_count; ++i) {
+      json += fmt::format(R"(, "field{}": {})", i, i);
+    }
+    json += "}";
+
+    for (auto const sorted_keys : {true, false}) {
+      auto const obj = uzleo::json::Parse(std::string_view{json},
+                                          {.sorted_keys = sorted_keys});
+      if (not obj.Contains(kValue) or obj.GetJson(kValue).GetDouble() != 42) {
+        throw std::runtime_error("Test failed: 'value' should be 42.");
+      }
+      if (obj.Contains(kMissing)) {
+        throw std::runtime_error("Test failed: 'missing' should not exist.");
+      }
+    }
+  }
+}
+
+void KeyTestCases() { TestKey_Lookup(); }
+
+auto TestCachedLookup_MixedShapes() {
+  fmt::println("Testing CachedLookup - Mixed shapes ...");
+  auto const json = uzleo::json::Parse(std::string_view{
+      R"([{"id": 1, "temp": 10}, {"id": 2, "temp": 20}, {"temp": 30},
+          {"id": 4}, {"id": 5, "x": 0, "temp": 50}])"});
+
+  uzleo::json::CachedLookup temp{"temp"};
+  std::vector<double> temps{};
+  for (auto const& record : json.GetArray()) {
+    if (auto const* value = temp.Find(record); value != nullptr) {
+      temps.push_back(value->GetDouble());
+    }
+  }
+
+  if (temps != std::vector{10.0, 20.0, 30.0, 50.0}) {
+    throw std::runtime_error("Test failed: wrong 'temp' values.");
+  }
+  try {
+    std::ignore = temp.Get(json.GetArray()[3]);
+    throw std::runtime_error(
+        "Test failed: Expected exception for missing key.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+  try {
+    std::ignore = temp.Find(json);
+    throw std::runtime_error(
+        "Test failed: Expected exception for non-object json.");
+  } catch (std::invalid_argument const&) {
+    throw std::runtime_error("Test failed: Unexpected exception type.");
+  } catch (std::logic_error const&) {
+    // Expected exception
+  }
+}
+
+void CachedLookupTestCases() { TestCachedLookup_MixedShapes(); }
+
+auto TestGetMany_SmallAndLargeObjects() {
+  fmt::println("Testing GetMany - Small and large objects ...");
+  static constexpr uzleo::json::Key kValue{"value"};
+
+  for (auto const member_count : {0, 20}) {
+    std::string json = R"({"name": "probe", "value": 7.5)";
+    for (int i = 0; i < member_count; ++i) {
+      json += fmt::format(R"(, "field{}": {})", i, i);
+    }
+    json += "}";
+
+    for (auto const sorted_keys : {true, false}) {
+      auto const obj = uzleo::json::Parse(std::string_view{json},
+                                          {.sorted_keys = sorted_keys});
+      auto const [name, missing, value] =
+          uzleo::json::GetMany(obj, "name", std::string{"missing"}, kValue);
+
+      if (not name or name->get().GetStringView() != "probe") {
+        throw std::runtime_error("Test failed: 'name' should be 'probe'.");
+      }
+      if (missing) {
+        throw std::runtime_error("Test failed: 'missing' should not exist.");
+      }
+      if (not value or value->get().GetDouble() != 7.5) {
+        throw std::runtime_error("Test failed: 'value' should be 7.5.");
+      }
+    }
+  }
+}
+
+void GetManyTestCases() { TestGetMany_SmallAndLargeObjects(); }
+
+auto TestWhitespace_PrettyPrinted() {
+  fmt::println("Testing Whitespace - Pretty printed ...");
+  std::string_view const pretty{
+      "{\n"
+      "    \"a\": [\n"
+      "        1,\t\r\n"
+      "                                        2\n"
+      "    ],\n"
+      "    \"b\":     {   \"c\" :\n\n\n null }\n"
+      "}\n"};
+  std::string_view const minified{R"({"a":[1,2],"b":{"c":null}})"};
+
+  if (not(uzleo::json::Parse(pretty) == uzleo::json::Parse(minified))) {
+    throw std::runtime_error("Test failed: documents should be equal.");
+  }
+}
+
+void WhitespaceTestCases() { TestWhitespace_PrettyPrinted(); }
+
+/// restores the kernel tier that was active at construction, also if a test
+/// throws
+class KernelTierGuard final {
+ public:
+  KernelTierGuard() = default;
+  KernelTierGuard(KernelTierGuard const&) = delete;
+  auto operator=(KernelTierGuard const&) -> KernelTierGuard& = delete;
+  ~KernelTierGuard() { uzleo::json::SetKernelTier(m_tier); }
+
+ private:
+  uzleo::json::KernelTier m_tier{uzleo::json::GetKernelTier()};
+};
+
+auto TestKernelTier_AllTiersAgree() {
+  fmt::println("Testing KernelTier - All tiers agree ...");
+  std::string_view const content{
+      "{\n                \"message\": \"a long string with \\\"escaped\\\" "
+      "quotes and a backslash \\\\ in the middle\",\n"
+      "\t\"numbers\": [0, -7, 12345678, -123456789012345, 1234567890123456, "
+      "3.25, -1e3, 00042],\r\n"
+      "                                  \"empty\": \"\"}"};
+
+  KernelTierGuard const tier_guard{};
+  uzleo::json::SetKernelTier(uzleo::json::KernelTier::kScalar);
+  auto const expected = uzleo::json::Parse(content);
+
+  for (auto const tier :
+       {uzleo::json::KernelTier::kSwar, uzleo::json::KernelTier::kSse42,
+        uzleo::json::KernelTier::kAvx2, uzleo::json::KernelTier::kAvx512}) {
+    if (not uzleo::json::IsKernelTierSupported(tier)) {
+      continue;
+    }
+    uzleo::json::SetKernelTier(tier);
+    if (not(uzleo::json::Parse(content) == expected)) {
+      throw std::runtime_error(
+          fmt::format("Test failed: tier {} differs from scalar tier.",
+                      std::to_underlying(tier)));
+    }
+  }
+
+  if (expected.GetJson("numbers").GetArray()[3].GetDouble() !=
+      -123456789012345.0) {
+    throw std::runtime_error("Test failed: wrong number.");
+  }
+}
+
+auto TestKernelTier_UnsupportedTier() {
+  fmt::println("Testing KernelTier - Unsupported tier ...");
+  auto const detected_tier = uzleo::json::DetectKernelTier();
+  if (not uzleo::json::IsKernelTierSupported(detected_tier) or
+      not uzleo::json::IsKernelTierSupported(
+          uzleo::json::KernelTier::kScalar)) {
+    throw std::runtime_error("Test failed: tier should be supported.");
+  }
+  if (detected_tier == uzleo::json::KernelTier::kAvx512) {
+    return;
+  }
+
+  try {
+    uzleo::json::SetKernelTier(uzleo::json::KernelTier::kAvx512);
+    throw std::runtime_error(
+        "Test failed: Expected exception for unsupported tier.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+}
+
+void KernelTierTestCases() {
+  TestKernelTier_AllTiersAgree();
+  TestKernelTier_UnsupportedTier();
+}
+
+auto TestIndex_FindAndParseSubtree() {
+  fmt::println("Testing Index - Find and parse subtree ...");
+  std::string_view const content{
+      R"({"a": [{"b": "x"}, {"b": 2, "c/d": [1, 2]}], "e~f": true})"};
+  auto const index = uzleo::json::BuildIndex(content);
+
+  if (index.Find("/a/0/b") != R"("x")" or index.Find("/a/1/c~1d/1") != "2" or
+      index.Find("/e~0f") != "true" or index.Find("") != content) {
+    throw std::runtime_error("Test failed: Index::Find returned wrong text.");
+  }
+  if (index.Contains("/a/2") or index.Contains("/a/x") or
+      index.Contains("/missing") or index.Contains("/e~0f/0")) {
+    throw std::runtime_error("Test failed: Index::Contains false positive.");
+  }
+  // only lexing and brackets are checked when building, not the keys
+  auto const malformed_index =
+      uzleo::json::BuildIndex(std::string_view{"{1: 2}"});
+  if (malformed_index.Find("/1") or malformed_index.Contains("/1")) {
+    throw std::runtime_error("Test failed: Index matched a non-string key.");
+  }
+
+  auto const subtree = uzleo::json::Parse(index, "/a/1");
+  auto const expected =
+      uzleo::json::Parse(std::string_view{R"({"b": 2, "c/d": [1, 2]})"});
+  if (subtree != expected or
+      uzleo::json::Parse(index) != uzleo::json::Parse(content)) {
+    throw std::runtime_error("Test failed: Index subtree parse mismatch.");
+  }
+
+  try {
+    [[maybe_unused]] auto const missing = uzleo::json::Parse(index, "/a/5");
+    throw std::runtime_error(
+        "Test failed: Expected exception for missing pointer.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+}
+
+auto TestIndex_SerializeRoundTrip() {
+  fmt::println("Testing Index - Serialize round trip ...");
+  auto const content =
+      std::make_shared<std::string const>(R"({"k": [1, {"v": null}]})");
+  auto const index = uzleo::json::Index::FromContent(
+      std::shared_ptr<std::string const>{content});
+  auto const bytes = index.Serialize();
+
+  auto const restored = uzleo::json::Index::Deserialize(
+      bytes, std::shared_ptr<std::string const>{content});
+  if (restored.TokenCount() != index.TokenCount() or
+      restored.Find("/k/1/v") != "null" or
+      uzleo::json::Parse(restored) != uzleo::json::Parse(index)) {
+    throw std::runtime_error("Test failed: restored index differs.");
+  }
+
+  try {
+    [[maybe_unused]] auto const other = uzleo::json::Index::Deserialize(
+        bytes,
+        std::make_shared<std::string const>(R"({"k": [1, {"v": true}]})"));
+    throw std::runtime_error(
+        "Test failed: Expected exception for different content.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+
+  // moves the "k" token (after the 32-byte header and the `{` token) to the
+  // begin of the content, where it has no quotation mark before it
+  auto corrupt_bytes = bytes;
+  std::uint32_t const offset{0};
+  std::memcpy(corrupt_bytes.data() + 32 + 9 + 1, &offset, sizeof(offset));
+  try {
+    [[maybe_unused]] auto const corrupt = uzleo::json::Index::Deserialize(
+        corrupt_bytes, std::shared_ptr<std::string const>{content});
+    throw std::runtime_error(
+        "Test failed: Expected exception for corrupt string token.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+}
+
+auto TestIndex_UnbalancedBrackets() {
+  fmt::println("Testing Index - Unbalanced brackets ...");
+  for (std::string_view const content : {"[1, 2", R"({"a": [1}]})", "]"}) {
+    try {
+      [[maybe_unused]] auto const index = uzleo::json::BuildIndex(content);
+      throw std::runtime_error(
+          "Test failed: Expected exception for unbalanced brackets.");
+    } catch (std::invalid_argument const&) {
+      // Expected exception
+    }
+  }
+}
+
+void IndexTestCases() {
+  TestIndex_FindAndParseSubtree();
+  TestIndex_SerializeRoundTrip();
+  TestIndex_UnbalancedBrackets();
+}
+
+auto TestStreamArray_Elements() {
+  fmt::println("Testing StreamArray - Elements ...");
+  std::string_view const content{
+      R"([ {"id": 1, "name": "a,]\"}"}, [1, [2]], "s\\", null , 4.5 ])"};
+  WriteFile(std::string{content});
+
+  auto const expected = uzleo::json::Parse(content);
+  std::size_t index{0};
+  for (auto& element :
+       uzleo::json::StreamArray(std::filesystem::path{kFilePath})) {
+    if (index >= std::ranges::size(expected.GetArray()) or
+        element != expected.GetArray()[index]) {
+      throw std::runtime_error(
+          fmt::format("Test failed: element {} differs.", index));
+    }
+    ++index;
+  }
+  if (index != std::ranges::size(expected.GetArray())) {
+    throw std::runtime_error("Test failed: StreamArray missed elements.");
+  }
+}
+
+auto TestStreamArray_EmptyArray() {
+  fmt::println("Testing StreamArray - Empty array ...");
+  WriteFile(" [ ]\n");
+
+  auto stream = uzleo::json::StreamArray(std::filesystem::path{kFilePath});
+  if (stream.begin() != stream.end()) {
+    throw std::runtime_error("Test failed: empty array yielded elements.");
+  }
+}
+
+auto TestStreamArray_Malformed() {
+  fmt::println("Testing StreamArray - Malformed content ...");
+  for (std::string_view const content :
+       {"[1, 2", "[1}]", "{}", "[1, ]", "[1] 2", "[1 2]", R"(["a": 1])",
+        "[1 : 2]"}) {
+    WriteFile(std::string{content});
+    try {
+      for (auto& element :
+           uzleo::json::StreamArray(std::filesystem::path{kFilePath})) {
+        [[maybe_unused]] auto const moved = std::move(element);
+      }
+      throw std::runtime_error(fmt::format(
+          "Test failed: Expected exception for content: {}", content));
+    } catch (std::invalid_argument const&) {
+      // Expected exception
+    } catch (std::runtime_error const& ex) {
+      if (std::string_view{ex.what()}.starts_with("Test failed")) {
+        throw;
+      }
+      // Expected exception from the parser
+    }
+  }
+}
+
+void StreamArrayTestCases() {
+  TestStreamArray_Elements();
+  TestStreamArray_EmptyArray();
+  TestStreamArray_Malformed();
+}
+
+auto TestEmbeddedJson_ParseAndCache() {
+  fmt::println("Testing EmbeddedJson - Parse and cache ...");
+  std::string_view const content{
+      R"({"payload": "{\"ids\": [1, 2], \"m\": \"a\\\\b\", \"k\u0041\": 0}"})"};
+  auto const event = uzleo::json::Parse(content);
+
+  auto const& payload = event.GetJson("payload").GetEmbeddedJson();
+  if (payload.GetJson("ids").GetArray()[1].GetDouble() != 2 or
+      payload.GetJson("m").GetStringView() != R"(a\\b)" or
+      not payload.Contains("kA")) {
+    throw std::runtime_error("Test failed: embedded json parsed wrongly.");
+  }
+  if (&event.GetJson("payload").GetEmbeddedJson() != &payload) {
+    throw std::runtime_error("Test failed: embedded json was not cached.");
+  }
+  if (not event.GetJson("payload").GetStringView().starts_with(R"({\"ids\")")) {
+    throw std::runtime_error("Test failed: raw string value changed.");
+  }
+}
+
+auto TestEmbeddedJson_Invalid() {
+  fmt::println("Testing EmbeddedJson - Invalid ...");
+  auto const event = uzleo::json::Parse(std::string_view{
+      R"({"number": 1, "empty": "  ", "bad_escape": "{\x}"})"});
+
+  for (auto const* const key : {"number", "empty", "bad_escape"}) {
+    try {
+      [[maybe_unused]] auto const& payload =
+          event.GetJson(key).GetEmbeddedJson();
+      throw std::runtime_error(
+          fmt::format("Test failed: Expected exception for {}.", key));
+    } catch (std::invalid_argument const&) {
+      // Expected exception
+    }
+  }
+}
+
+auto TestEmbeddedJson_Concurrent() {
+  fmt::println("Testing EmbeddedJson - Concurrent calls ...");
+  auto const event = uzleo::json::Parse(
+      std::string_view{R"({"payload": "{\"ids\": [1, 2, 3]}"})"});
+  auto const& payload = event.GetJson("payload");
+
+  std::array<uzleo::json::Json const*, 4> embedded{};
+  {
+    std::vector<std::jthread> threads{};
+    for (auto& result : embedded) {
+      threads.emplace_back(
+          [&payload, &result] { result = &payload.GetEmbeddedJson(); });
+    }
+  }
+  if (std::ranges::count(embedded, embedded.front()) != 4 or
+      embedded.front()->GetJson("ids").GetArray().size() != 3) {
+    throw std::runtime_error(
+        "Test failed: concurrent calls got different embedded json.");
+  }
+}
+
+void EmbeddedJsonTestCases() {
+  TestEmbeddedJson_ParseAndCache();
+  TestEmbeddedJson_Invalid();
+  TestEmbeddedJson_Concurrent();
+}
+
+auto TestBytes_BlobRoundTrip() {
+  fmt::println("Testing Bytes - Blob round trip ...");
+  std::mt19937 generator{7};
+  KernelTierGuard const tier_guard{};
+  for (auto const tier :
+       {uzleo::json::KernelTier::kScalar, uzleo::json::KernelTier::kSse42,
+        uzleo::json::KernelTier::kAvx2}) {
+    if (not uzleo::json::IsKernelTierSupported(tier)) {
+      continue;
+    }
+    uzleo::json::SetKernelTier(tier);
+
+    std::vector<std::byte> buffer{};
+    for (std::size_t size{0}; size < 200; ++size) {
+      std::vector<std::byte> bytes(size);
+      std::ranges::generate(bytes,
+                            [&generator] { return std::byte(generator()); });
+      auto const blob = uzleo::json::Json{std::vector<std::byte>{bytes}};
+      if (not std::ranges::equal(blob.GetBytes(buffer), bytes)) {
+        throw std::runtime_error("Test failed: blob bytes differ.");
+      }
+
+      auto const dumped = blob.Dump();
+      auto const parsed = uzleo::json::Parse(std::string_view{dumped});
+      if (std::ranges::size(dumped) != (size + 2) / 3 * 4 + 2 or
+          not std::ranges::equal(parsed.GetBytes(buffer), bytes)) {
+        throw std::runtime_error(
+            fmt::format("Test failed: base64 round trip of {} bytes.", size));
+      }
+    }
+  }
+}
+
+auto TestBytes_DecodeString() {
+  fmt::println("Testing Bytes - Decode string ...");
+  auto const json = uzleo::json::Parse(std::string_view{
+      R"({"padded": "aGVsbG8=", "unpadded": "aGVsbG8", "slash": "\/w==",)"
+      R"( "invalid": "aGV$bG8=", "short": "a", "number": 1})"});
+
+  std::vector<std::byte> buffer{};
+  auto const as_string = [&buffer](uzleo::json::Json const& value) {
+    auto const bytes = value.GetBytes(buffer);
+    return std::string{reinterpret_cast<char const*>(bytes.data()),
+                       bytes.size()};
+  };
+  if (as_string(json.GetJson("padded")) != "hello" or
+      as_string(json.GetJson("unpadded")) != "hello" or
+      as_string(json.GetJson("slash")) != "\xff") {
+    throw std::runtime_error("Test failed: base64 string decoded wrongly.");
+  }
+
+  for (auto const* const key : {"invalid", "short", "number"}) {
+    try {
+      [[maybe_unused]] auto const bytes = json.GetJson(key).GetBytes(buffer);
+      throw std::runtime_error(
+          fmt::format("Test failed: Expected exception for {}.", key));
+    } catch (std::invalid_argument const&) {
+      // Expected exception
+    }
+  }
+}
+
+void BytesTestCases() {
+  TestBytes_BlobRoundTrip();
+  TestBytes_DecodeString();
+}
+
+auto ReadWholeFile(std::filesystem::path const& path) -> std::string {
+  std::ifstream file_stream{path, std::ios::binary};
+  return std::string{std::istreambuf_iterator<char>{file_stream}, {}};
+}
+
+auto TestDumpToFile_MatchesDump() {
+  fmt::println("Testing DumpToFile - Matches Dump ...");
+  auto json = uzleo::json::Parse(std::string_view{
+      R"({"a": [1, 2.5, -3e20, true, null], "b": {"c": "x\"y"}, "d": []})"});
+  auto map = std::move(json).GetMap();
+  map.emplace("blob",
+              uzleo::json::Json{std::vector<std::byte>(5000, std::byte{7})});
+  auto const document = uzleo::json::Json{std::move(map)};
+
+  auto const file_path =
+      std::filesystem::temp_directory_path() / "uzleo_json_dump_test.json";
+  for (auto const sync : {true, false}) {
+    uzleo::json::DumpToFile(std::filesystem::path{file_path}, document,
+                            {.sync = sync, .buffer_size = 64});
+    if (ReadWholeFile(file_path) != document.Dump()) {
+      throw std::runtime_error("Test failed: DumpToFile differs from Dump.");
+    }
+  }
+  std::filesystem::remove(file_path);
+}
+
+auto TestDumpToFile_ReplacesAtomically() {
+  fmt::println("Testing DumpToFile - Replaces atomically ...");
+  auto const directory = std::filesystem::temp_directory_path() /
+                         "uzleo_json_dump_test_directory";
+  std::filesystem::create_directories(directory);
+  auto const file_path = directory / "snapshot.json";
+
+  uzleo::json::DumpToFile(std::filesystem::path{file_path},
+                          uzleo::json::Json{1.0});
+  uzleo::json::DumpToFile(std::filesystem::path{file_path},
+                          uzleo::json::Json{true});
+  if (ReadWholeFile(file_path) != "true" or
+      std::ranges::distance(std::filesystem::directory_iterator{directory},
+                            std::filesystem::directory_iterator{}) != 1) {
+    throw std::runtime_error("Test failed: snapshot not replaced cleanly.");
+  }
+
+  try {
+    uzleo::json::DumpToFile(directory / "missing" / "snapshot.json",
+                            uzleo::json::Json{true});
+    throw std::runtime_error(
+        "Test failed: Expected exception for missing directory.");
+  } catch (std::runtime_error const& ex) {
+    if (std::string_view{ex.what()}.starts_with("Test failed")) {
+      throw;
+    }
+    // Expected exception
+  }
+  std::filesystem::remove_all(directory);
+}
+
+auto TestDumpToFile_KeepsPermissions() {
+  fmt::println("Testing DumpToFile - Keeps permissions ...");
+  namespace fs = std::filesystem;
+  auto const file_path =
+      fs::temp_directory_path() / "uzleo_json_dump_permissions_test.json";
+  uzleo::json::DumpToFile(fs::path{file_path}, uzleo::json::Json{1.0});
+  fs::permissions(file_path, fs::perms::owner_read | fs::perms::owner_write);
+
+  uzleo::json::DumpToFile(fs::path{file_path}, uzleo::json::Json{true});
+  if (fs::status(file_path).permissions() !=
+          (fs::perms::owner_read | fs::perms::owner_write) or
+      ReadWholeFile(file_path) != "true") {
+    throw std::runtime_error("Test failed: permissions of replaced file.");
+  }
+  fs::remove(file_path);
+}
+
+void DumpToFileTestCases() {
+  TestDumpToFile_MatchesDump();
+  TestDumpToFile_ReplacesAtomically();
+  TestDumpToFile_KeepsPermissions();
+}
+
+auto TestFormatter_Specs() {
+  fmt::println("Testing Formatter - Specs ...");
+  auto const json = uzleo::json::Parse(
+      std::string_view{R"({"a": [true, null, {}], "b": {"x": 1}})"});
+
+  if (fmt::format("{}", json) != json.Dump() or
+      std::format("{}", json) != json.Dump()) {
+    throw std::runtime_error("Test failed: default spec differs from Dump.");
+  }
+  if (fmt::format("{:c}", json) != R"({"a":[true,null,{}],"b":{"x":1}})" or
+      std::format("{:c}", json) != fmt::format("{:c}", json)) {
+    throw std::runtime_error("Test failed: compact spec.");
+  }
+
+  constexpr std::string_view kPretty{R"({
+  "a": [
+    true,
+    null,
+    {}
+  ],
+  "b": {
+    "x": 1
+  }
+})"};
+  if (fmt::format("{:p}", json) != kPretty or
+      std::format("{:p}", json) != kPretty or
+      fmt::format("{:p4}", json).find("\n    \"a\": [\n        true") ==
+          std::string::npos) {
+    throw std::runtime_error("Test failed: pretty spec.");
+  }
+}
+
+auto TestFormatter_MaxLength() {
+  fmt::println("Testing Formatter - Max length ...");
+  auto const json = uzleo::json::Parse(
+      std::string_view{R"({"a": [true, null, {}], "b": {"x": 1}})"});
+
+  // the cap includes the marker, like DumpTruncated()
+  if (fmt::format("{:.10}", json) != R"({"a": [...)" or
+      std::format("{:c.20}", json) != R"({"a":[true,null,{...)" or
+      fmt::format("{:.10}", json) != uzleo::json::DumpTruncated(json, 10) or
+      fmt::format("{:.1000}", json) != json.Dump()) {
+    throw std::runtime_error("Test failed: max length spec.");
+  }
+
+  std::string buffer{};
+  fmt::format_to(std::back_inserter(buffer), "{} {:c}", json, json);
+  if (buffer != json.Dump() + " " + fmt::format("{:c}", json)) {
+    throw std::runtime_error("Test failed: format_to into buffer.");
+  }
+}
+
+void FormatterTestCases() {
+  TestFormatter_Specs();
+  TestFormatter_MaxLength();
+}
+
+auto TestDumpTruncated_Limits() {
+  fmt::println("Testing DumpTruncated - Limits ...");
+  auto const json = uzleo::json::Parse(
+      std::string_view{R"({"a": [true, null, {}], "b": {"x": 1}})"});
+  auto const dumped = json.Dump();
+
+  if (uzleo::json::DumpTruncated(json, std::ranges::size(dumped)) != dumped or
+      uzleo::json::DumpTruncated(json, 1000) != dumped) {
+    throw std::runtime_error("Test failed: fitting dump was truncated.");
+  }
+  for (std::size_t max_bytes{0}; max_bytes < std::ranges::size(dumped);
+       ++max_bytes) {
+    auto const truncated = uzleo::json::DumpTruncated(json, max_bytes);
+    auto const prefix_size = max_bytes < 3 ? 0 : max_bytes - 3;
+    if (std::ranges::size(truncated) != max_bytes or
+        not truncated.ends_with(std::string_view{"..."}.substr(0, max_bytes)) or
+        truncated.substr(0, prefix_size) != dumped.substr(0, prefix_size)) {
+      throw std::runtime_error(
+          fmt::format("Test failed: truncation to {} bytes.", max_bytes));
+    }
+  }
+  if (uzleo::json::DumpTruncated(json, 12, " [cut]") != R"({"a":  [cut])") {
+    throw std::runtime_error("Test failed: custom marker.");
+  }
+}
+
+auto TestDumpTruncated_LargeDocument() {
+  fmt::println("Testing DumpTruncated - Large document ...");
+  uzleo::json::Json::json_array_t records{};
+  for (std::size_t index{0}; index < 100'000; ++index) {
+    records.emplace_back(std::string_view{"éééé"});
+  }
+  auto const json = uzleo::json::Json{std::move(records)};
+
+  // never splits the two byte sequences of the strings
+  for (std::size_t max_bytes{10}; max_bytes < 30; ++max_bytes) {
+    auto const truncated = uzleo::json::DumpTruncated(json, max_bytes);
+    if (std::ranges::size(truncated) > max_bytes or
+        std::ranges::size(truncated) + 1 < max_bytes or
+        not json.Dump().starts_with(
+            std::string_view{truncated}.substr(0, truncated.size() - 3))) {
+      throw std::runtime_error(
+          fmt::format("Test failed: truncation to {} bytes.", max_bytes));
+    }
+  }
+}
+
+void DumpTruncatedTestCases() {
+  TestDumpTruncated_Limits();
+  TestDumpTruncated_LargeDocument();
+}
+
+auto TestFrozen_Sharing() {
+  fmt::println("Testing Frozen - Sharing across documents ...");
+  uzleo::json::FrozenPool pool{};
+  auto const first = uzleo::json::Freeze(
+      std::string_view{
+          R"({"id": 1, "meta": {"unit": "C", "tags": ["a"]}, "v": [2, 2]})"},
+      pool);
+  auto const node_count = pool.NodeCount();
+  auto const second = uzleo::json::Freeze(
+      std::string_view{
+          R"({"id": 2, "meta": {"unit": "C", "tags": ["a"]}, "v": [2, 2]})"},
+      pool);
+
+  if (first.IsSameNode(second) or first == second) {
+    throw std::runtime_error("Test failed: different documents shared.");
+  }
+  if (not first.GetJson("meta").IsSameNode(second.GetJson("meta")) or
+      not first.GetJson("v").IsSameNode(second.GetJson("v")) or
+      not first.GetJson("v").GetArray()[0].IsSameNode(
+          first.GetJson("v").GetArray()[1])) {
+    throw std::runtime_error("Test failed: equal subtrees not shared.");
+  }
+  // only the new id number and the new root
+  if (pool.NodeCount() != node_count + 2) {
+    throw std::runtime_error(
+        fmt::format("Test failed: {} nodes after second document.",
+                    pool.NodeCount()));
+  }
+
+  auto const reordered = uzleo::json::Freeze(
+      std::string_view{
+          R"({"v": [2, 2], "meta": {"tags": ["a"], "unit": "C"}, "id": 1})"},
+      pool);
+  if (reordered != first or reordered.IsSameNode(first)) {
+    throw std::runtime_error("Test failed: member order comparison.");
+  }
+}
+
+auto TestFrozen_ToJson() {
+  fmt::println("Testing Frozen - ToJson ...");
+  auto const content = std::string_view{
+      R"({"a": [true, false, null, -1.5, "x\"y"], "b": {}, "c": [{"d": 1}]})"};
+  uzleo::json::FrozenPool pool{};
+  auto const frozen = uzleo::json::Freeze(content, pool);
+
+  if (frozen.ToJson() != uzleo::json::Parse(content) or
+      frozen.Dump() != uzleo::json::Parse(content).Dump()) {
+    throw std::runtime_error("Test failed: thawed document differs.");
+  }
+  if (frozen.GetJson("a").GetArray()[4].GetStringView() != R"(x\"y)" or
+      frozen.GetJson("a").GetArray()[3].GetDouble() != -1.5 or
+      not frozen.GetJson("c").GetArray()[0].Contains("d") or
+      frozen.GetJson("b").Contains("d")) {
+    throw std::runtime_error("Test failed: accessors.");
+  }
+  try {
+    std::ignore = uzleo::json::Freeze(std::string_view{R"({"a": 1,)"}, pool);
+    throw std::runtime_error("Test failed: Expected exception for malformed.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+}
+
+auto TestFrozen_Collect() {
+  fmt::println("Testing Frozen - Collect ...");
+  uzleo::json::FrozenPool pool{};
+  auto const kept = uzleo::json::Freeze(
+      std::string_view{R"({"kept": [1, 2], "shared": "s"})"}, pool);
+  auto const node_count = pool.NodeCount();
+  auto const string_count = pool.StringCount();
+  {
+    auto const dropped = uzleo::json::Freeze(
+        std::string_view{R"({"dropped": [[3]], "shared": "s"})"}, pool);
+  }
+
+  pool.Collect();
+  if (pool.NodeCount() != node_count or pool.StringCount() != string_count) {
+    throw std::runtime_error(
+        fmt::format("Test failed: {} nodes and {} strings after collect.",
+                    pool.NodeCount(), pool.StringCount()));
+  }
+  if (kept.Dump() != R"({"kept": [1, 2], "shared": "s"})") {
+    throw std::runtime_error("Test failed: collected referenced nodes.");
+  }
+}
+
+void FrozenTestCases() {
+  TestFrozen_Sharing();
+  TestFrozen_ToJson();
+  TestFrozen_Collect();
+}
+
+auto TestCompact_Navigation() {
+  fmt::println("Testing Compact - Navigation ...");
+  auto const json = uzleo::json::Parse(std::string_view{
+      R"({"id": 7, "name": "s\"7", "loc": {"lat": 48.137, "lon": -11},
+          "tags": ["a", "b", "a"], "on": true, "off": false, "none": null,
+          "empty": {}, "list": []})"});
+  auto const compact = uzleo::json::CompactJson::FromJson(json);
+  auto const root = compact.Root();
+
+  if (root.Size() != 9 or root.GetJson("id").GetDouble() != 7.0 or
+      root.GetJson("name").GetStringView() != R"(s\"7)" or
+      root.GetJson("loc").GetJson("lat").GetDouble() != 48.137 or
+      root.GetJson("loc").GetJson("lon").GetDouble() != -11.0 or
+      root.GetJson("tags").At(2).GetStringView() != "a" or
+      not root.GetJson("on").IsType<bool>() or
+      not root.GetJson("none").IsType<std::monostate>() or
+      root.GetJson("empty").Size() != 0 or root.GetJson("list").Size() != 0) {
+    throw std::runtime_error("Test failed: navigation.");
+  }
+  if (root.Contains("lat") or not root.GetJson("loc").Contains("lat")) {
+    throw std::runtime_error("Test failed: Contains.");
+  }
+  if (root.ToJson() != json or
+      root.GetJson("loc").ToJson() != json.GetJson("loc")) {
+    throw std::runtime_error("Test failed: decompressed document differs.");
+  }
+
+  try {
+    std::ignore = root.GetJson("tags").At(3);
+    throw std::runtime_error("Test failed: Expected exception for index.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+  try {
+    std::ignore = root.GetJson("id").Contains("x");
+    throw std::runtime_error("Test failed: Expected exception for non-object.");
+  } catch (std::logic_error const&) {
+    // Expected exception
+  }
+}
+
+auto TestCompact_LargeDocument() {
+  fmt::println("Testing Compact - Large document ...");
+  uzleo::json::Json::json_array_t records{};
+  for (std::size_t index{0}; index < 2'000; ++index) {
+    uzleo::json::Json::json_object_t record{};
+    record.emplace("id", uzleo::json::Json{static_cast<double>(index)});
+    record.emplace("ratio", uzleo::json::Json{static_cast<double>(index) / 3});
+    record.emplace("kind", uzleo::json::Json{std::string_view{
+                               index % 2 == 0 ? "even" : "odd"}});
+    records.emplace_back(std::move(record));
+  }
+  auto const json = uzleo::json::Json{std::move(records)};
+  auto const compact = uzleo::json::CompactJson::FromJson(json);
+
+  for (std::size_t index{0}; index < 2'000; index += 37) {
+    auto const record = compact.Root().At(index);
+    if (record.GetJson("id").GetDouble() != static_cast<double>(index) or
+        record.GetJson("ratio").GetDouble() != static_cast<double>(index) / 3 or
+        record.GetJson("kind").GetStringView() !=
+            (index % 2 == 0 ? "even" : "odd")) {
+      throw std::runtime_error(
+          fmt::format("Test failed: record {} differs.", index));
+    }
+  }
+  if (compact.Root().ToJson() != json or compact.NodeCount() != 8'001 or
+      compact.ByteSize() >= json.Dump().size()) {
+    throw std::runtime_error(
+        fmt::format("Test failed: {} bytes compacted.", compact.ByteSize()));
+  }
+}
+
+void CompactTestCases() {
+  TestCompact_Navigation();
+  TestCompact_LargeDocument();
+}
+
+auto TestDelta_Stream() {
+  fmt::println("Testing Delta - Stream of documents ...");
+  std::array const documents{
+      std::string_view{R"({"id": "p1", "t": 20.5, "ok": true,
+                          "axes": [1, 2, 3], "meta": {"a": 1, "b": 2}})"},
+      // one value changed
+      std::string_view{R"({"id": "p1", "t": 20.75, "ok": true,
+                          "axes": [1, 2, 3], "meta": {"a": 1, "b": 2}})"},
+      // members removed and added, array grows
+      std::string_view{R"({"id": "p1", "t": 20.75, "axes": [1, 2, 3, 4],
+                          "meta": {"b": 2, "c": null}, "new": [true]})"},
+      // array shrinks, type changes
+      std::string_view{R"({"id": 7, "t": -0.0, "axes": [1],
+                          "meta": {"b": {"x": "y"}, "c": null}, "new": []})"},
+      // root replaced
+      std::string_view{R"([false, null])"}};
+
+  uzleo::json::DeltaEncoder encoder{};
+  uzleo::json::DeltaDecoder decoder{};
+  std::vector<std::size_t> delta_sizes{};
+  for (auto const content : documents) {
+    auto const json = uzleo::json::Parse(content);
+    auto const delta = encoder.Encode(json);
+    delta_sizes.push_back(std::ranges::size(delta));
+    if (decoder.Apply(delta) != json) {
+      throw std::runtime_error(
+          fmt::format("Test failed: patched document differs from {}.",
+                      content));
+    }
+  }
+
+  // sequence number, replace op, path of depth 1, double, end
+  if (delta_sizes[1] != 1 + 1 + 2 + 9 + 1) {
+    throw std::runtime_error(fmt::format(
+        "Test failed: delta of one changed number has {} bytes.",
+        delta_sizes[1]));
+  }
+  if (std::ranges::size(encoder.Encode(uzleo::json::Parse(documents[4]))) !=
+      2) {
+    throw std::runtime_error("Test failed: delta of same document.");
+  }
+}
+
+auto TestDelta_Errors() {
+  fmt::println("Testing Delta - Errors ...");
+  uzleo::json::DeltaEncoder encoder{};
+  auto const first =
+      encoder.Encode(uzleo::json::Parse(std::string_view{"[1]"}));
+  auto const second =
+      encoder.Encode(uzleo::json::Parse(std::string_view{"[1, 2]"}));
+
+  uzleo::json::DeltaDecoder decoder{};
+  try {
+    std::ignore = decoder.Apply(second);
+    throw std::runtime_error("Test failed: Expected exception for order.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+  try {
+    std::ignore = decoder.Apply(std::span{first}.first(3));
+    throw std::runtime_error("Test failed: Expected exception for truncation.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+  try {
+    // a failed delta breaks the stream
+    std::ignore = decoder.Apply(first);
+    throw std::runtime_error("Test failed: Expected exception after failure.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+  try {
+    // an empty delta whose sequence number is the maximal varint
+    std::vector<std::byte> delta(9, std::byte{0xff});
+    delta.push_back(std::byte{0x01});
+    delta.push_back(std::byte{0x00});
+    std::ignore = decoder.Apply(delta);
+    throw std::runtime_error(
+        "Test failed: Expected exception for any sequence after failure.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+}
+
+void DeltaTestCases() {
+  TestDelta_Stream();
+  TestDelta_Errors();
+}
+
+auto TestSortNdjson_Runs() {
+  fmt::println("Testing SortNdjson - Runs ...");
+  static constexpr std::string_view kOutputPath{"/tmp/test_sorted.ndjson"};
+  WriteFile(
+      R"({"k": {"v": 3}, "id": "a"})"
+      "\n"
+      R"({"id": "b"})"
+      "\n\n"
+      R"({"k": {"v": "x,}\"y"}, "id": "c"})"
+      "\n"
+      R"(  {"id": "d", "k": {"w": 0, "v": -1.5}})"
+      "\n"
+      R"({"k": {"v": 3}, "id": "e"})"
+      "\n"
+      R"({"k": {"v": null}, "id": "f"})");
+
+  // a budget of a few bytes spills every record into its own run
+  for (auto const memory_budget : {std::size_t{1} << 20, std::size_t{8}}) {
+    auto const record_count = uzleo::json::SortNdjson(
+        kFilePath, kOutputPath, "/k/v",
+        {.memory_budget = memory_budget, .thread_count = 2, .sync = false});
+    auto const expected = std::string{
+        R"({"id": "b"})"
+        "\n"
+        R"({"k": {"v": null}, "id": "f"})"
+        "\n"
+        R"(  {"id": "d", "k": {"w": 0, "v": -1.5}})"
+        "\n"
+        R"({"k": {"v": 3}, "id": "a"})"
+        "\n"
+        R"({"k": {"v": 3}, "id": "e"})"
+        "\n"
+        R"({"k": {"v": "x,}\"y"}, "id": "c"})"
+        "\n"};
+    if (record_count != 6 or ReadWholeFile(kOutputPath) != expected) {
+      throw std::runtime_error(fmt::format(
+          "Test failed: sorted output with budget {}.", memory_budget));
+    }
+  }
+}
+
+auto TestSortNdjson_ManyRecords() {
+  fmt::println("Testing SortNdjson - Many records ...");
+  static constexpr std::string_view kOutputPath{"/tmp/test_sorted.ndjson"};
+  // few distinct keys, so stability is checked on many ties
+  std::vector<std::pair<int, std::string>> records{};
+  std::string content{};
+  for (int index{0}; index < 3 * 4096; ++index) {
+    auto const key = index * 7919 % 97;
+    records.emplace_back(key,
+                         fmt::format(R"({{"k": {}, "id": {}}})", key, index));
+    content += records.back().second + "\n";
+  }
+  WriteFile(content);
+  std::ranges::stable_sort(records, {}, &std::pair<int, std::string>::first);
+  std::string expected{};
+  for (auto const& [key, record] : records) {
+    expected += record + "\n";
+  }
+
+  // 3 parts of 4096 records sorted on threads and merged in memory
+  auto record_count = uzleo::json::SortNdjson(
+      kFilePath, kOutputPath, "/k",
+      {.memory_budget = std::size_t{1} << 20, .thread_count = 3,
+       .sync = false});
+  if (record_count != std::ranges::size(records) or
+      ReadWholeFile(kOutputPath) != expected) {
+    throw std::runtime_error("Test failed: sorted parts merged wrongly.");
+  }
+
+  // runs of ~90 records, merged in two passes of at most 64 runs each
+  record_count = uzleo::json::SortNdjson(
+      kFilePath, kOutputPath, "/k",
+      {.memory_budget = 2048, .thread_count = 2, .sync = false});
+  if (record_count != std::ranges::size(records) or
+      ReadWholeFile(kOutputPath) != expected) {
+    throw std::runtime_error("Test failed: multi-pass merge of runs.");
+  }
+}
+
+auto TestSortNdjson_Errors() {
+  fmt::println("Testing SortNdjson - Errors ...");
+  for (std::string_view const content :
+       {R"({"k": "unterminated})", R"({"k": "lone backslash\)",
+        R"({"k": 1x})", R"({"k": -})", R"({"k": nope})", R"({"k": fals})",
+        R"({"k": tx})"}) {
+    WriteFile(std::string{content});
+    try {
+      std::ignore = uzleo::json::SortNdjson(
+          kFilePath, "/tmp/test_sorted.ndjson", "/k", {.sync = false});
+      throw std::runtime_error(
+          fmt::format("Test failed: Expected exception for {}.", content));
+    } catch (std::invalid_argument const&) {
+      // Expected exception
+    }
+  }
+  try {
+    std::ignore = uzleo::json::SortNdjson(kFilePath, "/tmp/test_sorted.ndjson",
+                                          "k", {.sync = false});
+    throw std::runtime_error("Test failed: Expected exception for pointer.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+}
+
+void SortNdjsonTestCases() {
+  TestSortNdjson_Runs();
+  TestSortNdjson_ManyRecords();
+  TestSortNdjson_Errors();
+}
+
+auto TestEditable_Splice() {
+  fmt::println("Testing Editable - Splice ...");
+  auto document = uzleo::json::EditableJson::FromContent(
+      R"({"a": [1, {"b": 22}], "c": "x", "d": [true]})");
+  if (document.RangeOf("/a/1/b") != uzleo::json::SourceRange{16, 18} or
+      document.RangeOf("/c") != uzleo::json::SourceRange{27, 30} or
+      document.RangeOf("/e").has_value() or
+      document.RangeOf("/a/2").has_value()) {
+    throw std::runtime_error("Test failed: ranges of parsed document.");
+  }
+
+  // only the innermost object around the number is re-parsed
+  auto const reparsed =
+      document.Apply({.offset = 16, .removed = 2, .inserted = "456"});
+  if (reparsed != uzleo::json::SourceRange{10, 20}) {
+    throw std::runtime_error(fmt::format(
+        "Test failed: re-parsed range {}-{}.", reparsed.begin, reparsed.end));
+  }
+  if (document.GetJson() != uzleo::json::Parse(document.Content()) or
+      document.RangeOf("/a/1/b") != uzleo::json::SourceRange{16, 19} or
+      document.RangeOf("/c") != uzleo::json::SourceRange{28, 31} or
+      document.RangeOf("/d/0") != uzleo::json::SourceRange{39, 43}) {
+    throw std::runtime_error("Test failed: document after edit.");
+  }
+
+  // adding a member to the root
+  std::ignore = document.Apply({.offset = 44, .inserted = R"(, "e": {})"});
+  if (document.Content() !=
+          R"({"a": [1, {"b": 456}], "c": "x", "d": [true], "e": {}})" or
+      document.GetJson() != uzleo::json::Parse(document.Content()) or
+      document.RangeOf("/e") != uzleo::json::SourceRange{51, 53}) {
+    throw std::runtime_error("Test failed: document after added member.");
+  }
+
+  // like Parse(), the first of duplicate keys wins
+  std::ignore = document.Apply({.offset = 53, .inserted = R"(, "c": 1)"});
+  if (document.GetJson() != uzleo::json::Parse(document.Content()) or
+      document.RangeOf("/c") != uzleo::json::SourceRange{28, 31}) {
+    throw std::runtime_error("Test failed: document after duplicate key.");
+  }
+}
+
+auto TestEditable_Escalation() {
+  fmt::println("Testing Editable - Escalation ...");
+  auto document = uzleo::json::EditableJson::FromContent(R"([[1, 2], 3])");
+  // splits the inner array, which no longer parses on its own
+  auto const reparsed =
+      document.Apply({.offset = 3, .removed = 1, .inserted = "], ["});
+  if (reparsed != uzleo::json::SourceRange{0, 14} or
+      document.Content() != "[[1], [ 2], 3]" or
+      document.GetJson() != uzleo::json::Parse(document.Content()) or
+      document.RangeOf("/1/0") != uzleo::json::SourceRange{8, 9} or
+      document.RangeOf("/2") != uzleo::json::SourceRange{12, 13}) {
+    throw std::runtime_error("Test failed: escalated edit.");
+  }
+}
+
+auto TestEditable_Errors() {
+  fmt::println("Testing Editable - Errors ...");
+  auto document = uzleo::json::EditableJson::FromContent(R"({"a": [1, 2]})");
+  try {
+    // unterminated string
+    std::ignore = document.Apply({.offset = 10, .inserted = "\""});
+    throw std::runtime_error("Test failed: Expected exception for edit.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+  try {
+    // truncated content
+    std::ignore = document.Apply({.offset = 11, .removed = 2});
+    throw std::runtime_error("Test failed: Expected exception for truncation.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+  if (document.Content() != R"({"a": [1, 2]})" or
+      document.GetJson() != uzleo::json::Parse(document.Content())) {
+    throw std::runtime_error("Test failed: document changed by failed edit.");
+  }
+  try {
+    std::ignore = document.Apply({.offset = 12, .removed = 2});
+    throw std::runtime_error("Test failed: Expected exception for range.");
+  } catch (std::out_of_range const&) {
+    // Expected exception
+  }
+}
+
+void EditableTestCases() {
+  TestEditable_Splice();
+  TestEditable_Escalation();
+  TestEditable_Errors();
+}
+
+/// counts values and sums numbers
+struct StatisticsVisitor {
+  struct state_type {
+    std::size_t value_count{0};
+    std::size_t max_depth{0};
+    double number_sum{0.0};
+  };
+
+  auto Visit(uzleo::json::Json const& json, std::size_t depth,
+             state_type& state) const -> void {
+    ++state.value_count;
+    state.max_depth = std::max(state.max_depth, depth);
+    if (json.IsType<double>()) {
+      state.number_sum += json.GetDouble();
+    }
+  }
+
+  auto Merge(state_type& state, state_type&& other) const -> void {
+    state.value_count += other.value_count;
+    state.max_depth = std::max(state.max_depth, other.max_depth);
+    state.number_sum += other.number_sum;
+  }
+};
+
+/// records the depths in visiting order
+struct DepthVisitor {
+  using state_type = std::vector<std::size_t>;
+
+  auto Visit(uzleo::json::Json const&, std::size_t depth,
+             state_type& state) const -> void {
+    state.push_back(depth);
+  }
+
+  auto Merge(state_type& state, state_type&& other) const -> void {
+    state.insert(state.end(), other.begin(), other.end());
+  }
+};
+
+auto TestVisit_Serial() {
+  fmt::println("Testing Visit - Serial ...");
+  auto const json =
+      uzleo::json::Parse(std::string_view{R"({"a": [1, [2]], "b": 3})"});
+  auto const pre_order = uzleo::json::Visit(
+      json, DepthVisitor{}, {.mode = uzleo::json::VisitMode::kPreOrder});
+  auto const post_order = uzleo::json::Visit(
+      json, DepthVisitor{}, {.mode = uzleo::json::VisitMode::kPostOrder});
+  if (pre_order != std::vector<std::size_t>{0, 1, 2, 2, 3, 1} or
+      post_order != std::vector<std::size_t>{2, 3, 2, 1, 1, 0}) {
+    throw std::runtime_error("Test failed: serial visiting order.");
+  }
+}
+
+auto TestVisit_Parallel() {
+  fmt::println("Testing Visit - Parallel ...");
+  std::string content{"["};
+  for (std::size_t record{0}; record < 5'000; ++record) {
+    content += fmt::format(R"({}{{"id": {}, "values": [{}, [{}]]}})",
+                           record == 0 ? "" : ", ", record, record % 7,
+                           record % 3);
+  }
+  content += "]";
+  auto const json = uzleo::json::Parse(std::string_view{content});
+
+  auto const expected = uzleo::json::Visit(
+      json, StatisticsVisitor{}, {.mode = uzleo::json::VisitMode::kPreOrder});
+  for (auto const thread_count : {1uz, 2uz, 4uz}) {
+    for (auto const split_size : {1uz, 64uz}) {
+      auto const statistics = uzleo::json::Visit(
+          json, StatisticsVisitor{},
+          {.thread_count = thread_count, .split_size = split_size});
+      if (statistics.value_count != expected.value_count or
+          statistics.max_depth != 4 or
+          statistics.number_sum != expected.number_sum) {
+        throw std::runtime_error(fmt::format(
+            "Test failed: statistics with {} threads, split size {}.",
+            thread_count, split_size));
+      }
+    }
+  }
+  if (expected.value_count != 1 + 5'000 * 6) {
+    throw std::runtime_error("Test failed: number of values.");
+  }
+}
+
+auto TestVisit_Errors() {
+  fmt::println("Testing Visit - Errors ...");
+  struct ThrowingVisitor {
+    using state_type = int;
+    auto Visit(uzleo::json::Json const& json, std::size_t, int&) const
+        -> void {
+      if (json.IsType<std::monostate>()) {
+        throw std::invalid_argument{"null value"};
+      }
+    }
+    auto Merge(int&, int&&) const -> void {}
+  };
+
+  std::string content{"["};
+  for (std::size_t element{0}; element < 1'000; ++element) {
+    content += element == 0 ? "" : ", ";
+    content += element == 600 ? "null" : "[true]";
+  }
+  content += "]";
+  auto const json = uzleo::json::Parse(std::string_view{content});
+  try {
+    std::ignore = uzleo::json::Visit(json, ThrowingVisitor{},
+                                     {.thread_count = 4, .split_size = 16});
+    throw std::runtime_error("Test failed: Expected exception from visitor.");
+  } catch (std::invalid_argument const&) {
+    // Expected exception
+  }
+}
+
+void VisitTestCases() {
+  TestVisit_Serial();
+  TestVisit_Parallel();
+  TestVisit_Errors();
+}
 }  // namespace
 
 auto main() -> int {
@@ -1234,6 +2627,66 @@ auto main() -> int {
     fmt::println("*** Testing ContainsAPI ***");
     ContainsApiTestCases();
 
+    fmt::println("*** Testing ObjectMap ***");
+    ObjectMapTestCases();
+
+    fmt::println("*** Testing SortedKeys ***");
+    SortedKeysTestCases();
+
+    fmt::println("*** Testing Key ***");
+    KeyTestCases();
+
+    fmt::println("*** Testing CachedLookup ***");
+    CachedLookupTestCases();
+
+    fmt::println("*** Testing GetMany ***");
+    GetManyTestCases();
+
+    fmt::println("*** Testing Whitespace ***");
+    WhitespaceTestCases();
+
+    fmt::println("*** Testing KernelTier ***");
+    KernelTierTestCases();
+
+    fmt::println("*** Testing Index ***");
+    IndexTestCases();
+
+    fmt::println("*** Testing StreamArray ***");
+    StreamArrayTestCases();
+
+    fmt::println("*** Testing EmbeddedJson ***");
+    EmbeddedJsonTestCases();
+
+    fmt::println("*** Testing Bytes ***");
+    BytesTestCases();
+
+    fmt::println("*** Testing DumpToFile ***");
+    DumpToFileTestCases();
+
+    fmt::println("*** Testing Formatter ***");
+    FormatterTestCases();
+
+    fmt::println("*** Testing DumpTruncated ***");
+    DumpTruncatedTestCases();
+
+    fmt::println("*** Testing Frozen ***");
+    FrozenTestCases();
+
+    fmt::println("*** Testing Compact ***");
+    CompactTestCases();
+
+    fmt::println("*** Testing Delta ***");
+    DeltaTestCases();
+
+    fmt::println("*** Testing SortNdjson ***");
+    SortNdjsonTestCases();
+
+    fmt::println("*** Testing Editable ***");
+    EditableTestCases();
+
+    fmt::println("*** Testing Visit ***");
+    VisitTestCases();
+
     fmt::println("-----------");
     fmt::println("all tests passed.");
   } catch (std::exception const& ex) {
@@ -0,0 +1,134 @@
+
+
+// built without exceptions like the module under test, so failures are
+// reported by Expect() and the exit code instead of thrown.
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+import uzleo.json.lite;
+
+namespace lite = uzleo::json::lite;
+
+namespace {
+
+auto Expect(bool condition, std::string_view message) -> void {
+  if (not condition) {
+    std::printf("    failed with info: Test failed: %.*s\n",
+                static_cast<int>(message.size()), message.data());
+    std::exit(1);
+  }
+}
+
+auto TestLite_Navigation() {
+  std::printf("Testing Lite - Navigation ...\n");
+  static constexpr std::string_view kContent{R"({
+    "app_name": "WeatherStationClient",
+    "version": 1.2,
+    "settings": {"units": "metric", "refresh_interval": 300},
+    "features": ["temperature", "humidity", "pressure"],
+    "debug": true, "empty": {}, "none": null, "quoted": "a\"b"
+  })"};
+  lite::Document<32, 4> document{};
+  Expect(document.Parse(kContent) == lite::Errc::kOk, "parse config");
+
+  auto const root{document.Root()};
+  Expect(root.Size() == 8 and root.GetKind() == lite::Kind::kObject,
+         "root object");
+  Expect(root.GetJson("app_name").GetStringView() == "WeatherStationClient",
+         "string member");
+  Expect(root.GetJson("version").GetDouble() == 1.2, "number member");
+  Expect(root.GetJson("settings").GetJson("refresh_interval").GetDouble() ==
+             300.0,
+         "nested member");
+  Expect(root.GetJson("features").At(2).GetStringView() == "pressure" and
+             not root.GetJson("features").At(3).IsValid(),
+         "array elements");
+  Expect(root.GetJson("debug").GetBool() == true and
+             root.GetJson("none").IsNull() and
+             root.GetJson("empty").Size() == 0,
+         "literals and empty object");
+  Expect(root.GetJson("quoted").GetStringView() == R"(a\"b)",
+         "escaped string kept as written");
+  Expect(not root.Contains("missing") and
+             not root.GetJson("missing").GetJson("x").GetDouble(),
+         "missing member");
+}
+
+auto TestLite_Errors() {
+  std::printf("Testing Lite - Errors ...\n");
+  struct ErrorCase {
+    std::string_view content;
+    lite::Errc errc;
+    std::size_t offset;
+  };
+  static constexpr std::array kCases{
+      ErrorCase{"", lite::Errc::kUnexpectedEnd, 0},
+      ErrorCase{R"({"a": 1)", lite::Errc::kUnexpectedEnd, 7},
+      ErrorCase{"[1,]", lite::Errc::kUnexpectedCharacter, 3},
+      ErrorCase{R"({"a" 1})", lite::Errc::kUnexpectedCharacter, 5},
+      ErrorCase{"[tru]", lite::Errc::kInvalidLiteral, 1},
+      ErrorCase{"[-]", lite::Errc::kInvalidNumber, 1},
+      ErrorCase{"[01]", lite::Errc::kInvalidNumber, 1},
+      ErrorCase{"[.5]", lite::Errc::kInvalidNumber, 1},
+      ErrorCase{"[1.]", lite::Errc::kInvalidNumber, 1},
+      ErrorCase{"[+1]", lite::Errc::kInvalidNumber, 1},
+      ErrorCase{"[1e]", lite::Errc::kInvalidNumber, 1},
+      ErrorCase{R"(["abc])", lite::Errc::kInvalidString, 1},
+      ErrorCase{"[[[[[1]]]]]", lite::Errc::kTooDeep, 4},
+      ErrorCase{"[1, 2, 3, 4]", lite::Errc::kOutOfNodes, 10},
+      ErrorCase{"[1] 2", lite::Errc::kUnexpectedCharacter, 4}};
+
+  lite::Document<4, 4> document{};
+  for (auto const& [content, errc, offset] : kCases) {
+    Expect(document.Parse(content) == errc and
+               document.ErrorOffset() == offset and
+               not document.Root().IsValid(),
+           content);
+  }
+}
+
+auto TestLite_Writer() {
+  std::printf("Testing Lite - Writer ...\n");
+  std::array<char, 128> buffer{};
+  lite::Writer writer{buffer};
+  writer.BeginObject();
+  writer.Key("t");
+  writer.Number(21.5);
+  writer.Key("a");
+  writer.BeginArray();
+  writer.Bool(true);
+  writer.Null();
+  writer.BeginObject();
+  writer.EndObject();
+  writer.String("s");
+  writer.EndArray();
+  writer.EndObject();
+  Expect(writer.Error() == lite::Errc::kOk and
+             writer.View() == R"({"t":21.5,"a":[true,null,{},"s"]})",
+         "written json");
+
+  std::array<char, 4> small_buffer{};
+  lite::Writer small_writer{small_buffer};
+  small_writer.BeginArray();
+  small_writer.Number(123456.0);
+  small_writer.EndArray();
+  Expect(small_writer.Error() == lite::Errc::kBufferFull and
+             small_writer.View() == "[",
+         "full buffer");
+}
+
+}  // namespace
+
+auto main() -> int {
+  std::printf("*** Testing Lite ***\n");
+  TestLite_Navigation();
+  TestLite_Errors();
+  TestLite_Writer();
+
+  std::printf("-----------\n");
+  std::printf("all tests passed.\n");
+  return 0;
+}